@@ -24,6 +24,7 @@ import (
 	"path/filepath"
 
 	"k8s.io/client-go/kubernetes"
+	"k8s.io/client-go/rest"
 	"k8s.io/klog/v2"
 	nfdclient "sigs.k8s.io/node-feature-discovery/pkg/generated/clientset/versioned"
 	"sigs.k8s.io/yaml"
@@ -35,11 +36,14 @@ type Collector interface {
 
 type Config struct {
 	Clientset kubernetes.Interface
-	NfdClient *nfdclient.Clientset
+	NfdClient nfdclient.Interface
 
 	artifactDir string
 	namespace   string
 
+	restConfig *rest.Config
+	protobuf   bool
+
 	log io.Writer
 }
 
@@ -17,9 +17,15 @@
 package diagnostics
 
 import (
+	"fmt"
+
+	"k8s.io/apimachinery/pkg/runtime"
 	"k8s.io/client-go/kubernetes"
+	"k8s.io/client-go/rest"
 	"k8s.io/klog/v2"
 	nfdclient "sigs.k8s.io/node-feature-discovery/pkg/generated/clientset/versioned"
+
+	"github.com/NVIDIA/k8s-test-infra/pkg/framework"
 )
 
 const (
@@ -65,7 +71,24 @@ func WithKubernetesClient(clientset kubernetes.Interface) func(*Diagnostic) {
 	}
 }
 
-func WithNFDClient(nfdClient *nfdclient.Clientset) func(*Diagnostic) {
+// WithRestConfig builds the Kubernetes and NFD clients from the given config
+// unless they are set explicitly with WithKubernetesClient or WithNFDClient.
+func WithRestConfig(config *rest.Config) func(*Diagnostic) {
+	return func(d *Diagnostic) {
+		d.Config.restConfig = config
+	}
+}
+
+// WithProtobuf makes the Kubernetes client built from WithRestConfig use the
+// protobuf wire format. The NFD client always uses JSON as CRDs have no
+// protobuf encoding.
+func WithProtobuf() func(*Diagnostic) {
+	return func(d *Diagnostic) {
+		d.Config.protobuf = true
+	}
+}
+
+func WithNFDClient(nfdClient nfdclient.Interface) func(*Diagnostic) {
 	return func(d *Diagnostic) {
 		d.NfdClient = nfdClient
 	}
@@ -115,5 +138,41 @@ func New(opts ...Option) (*Diagnostic, error) {
 		opt(dc)
 	}
 
+	if err := c.buildClients(); err != nil {
+		return nil, err
+	}
+
 	return dc, nil
 }
+
+// buildClients creates the clients that were not provided explicitly.
+func (c *Config) buildClients() error {
+	if c.restConfig == nil {
+		return nil
+	}
+
+	if c.Clientset == nil {
+		config := c.restConfig
+		if c.protobuf {
+			config = framework.ProtobufConfig(config)
+		}
+		clientset, err := kubernetes.NewForConfig(config)
+		if err != nil {
+			return fmt.Errorf("error creating kubernetes client: %w", err)
+		}
+		c.Clientset = clientset
+	}
+
+	if c.NfdClient == nil {
+		config := rest.CopyConfig(c.restConfig)
+		config.ContentType = runtime.ContentTypeJSON
+		config.AcceptContentTypes = runtime.ContentTypeJSON
+		nfdClient, err := nfdclient.NewForConfig(config)
+		if err != nil {
+			return fmt.Errorf("error creating NFD client: %w", err)
+		}
+		c.NfdClient = nfdClient
+	}
+
+	return nil
+}
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"context"
+	"net/http"
+	"strconv"
+	"strings"
+	"sync"
+	"time"
+
+	"go.opentelemetry.io/otel"
+	"go.opentelemetry.io/otel/attribute"
+	"go.opentelemetry.io/otel/codes"
+	"go.opentelemetry.io/otel/metric"
+	"go.opentelemetry.io/otel/trace"
+	restclient "k8s.io/client-go/rest"
+	"k8s.io/client-go/util/flowcontrol"
+)
+
+const (
+	// APIStatsReportEntry is the name of the report entry holding the API
+	// call statistics of a spec.
+	APIStatsReportEntry = "API calls"
+
+	instrumentationName = "github.com/NVIDIA/k8s-test-infra/pkg/framework"
+)
+
+// APILatencyBuckets are the upper bounds of the request latency histogram.
+// Requests slower than the last bound are counted in an extra overflow bucket.
+var APILatencyBuckets = []time.Duration{
+	5 * time.Millisecond,
+	10 * time.Millisecond,
+	25 * time.Millisecond,
+	50 * time.Millisecond,
+	100 * time.Millisecond,
+	250 * time.Millisecond,
+	500 * time.Millisecond,
+	time.Second,
+	2500 * time.Millisecond,
+	5 * time.Second,
+}
+
+// APIStats accounts for the API calls issued by the clients of a single spec.
+// It is safe for concurrent use.
+type APIStats struct {
+	mu sync.Mutex
+
+	spec string
+
+	// Requests is the total number of requests sent to the apiserver.
+	Requests int `json:"requests"`
+	// Calls counts requests by "verb resource", e.g. "list nodes".
+	Calls map[string]int `json:"calls"`
+	// LatencyHistogram counts requests per APILatencyBuckets bound, with
+	// the last element counting requests slower than every bound.
+	LatencyHistogram []int `json:"latencyHistogram"`
+	// Latency is the accumulated time spent waiting on the apiserver.
+	Latency time.Duration `json:"latency"`
+	// ThrottleWait is the accumulated time spent in the client-side rate limiter.
+	ThrottleWait time.Duration `json:"throttleWait"`
+
+	requests metric.Int64Counter
+	duration metric.Float64Histogram
+}
+
+// NewAPIStats returns an empty APIStats for the given spec.
+func NewAPIStats(spec string) *APIStats {
+	s := &APIStats{
+		spec:             spec,
+		Calls:            map[string]int{},
+		LatencyHistogram: make([]int, len(APILatencyBuckets)+1),
+	}
+
+	// Errors only occur for invalid instrument names; fall back to no-ops.
+	meter := otel.Meter(instrumentationName)
+	s.requests, _ = meter.Int64Counter("e2e.apiserver.requests",
+		metric.WithDescription("Number of requests sent to the apiserver by a spec"))
+	s.duration, _ = meter.Float64Histogram("e2e.apiserver.request.duration",
+		metric.WithDescription("Latency of requests sent to the apiserver by a spec"),
+		metric.WithUnit("s"))
+
+	return s
+}
+
+// WrapTransport instruments every request going through rt. It can be used as
+// a rest.Config WrapTransport.
+func (s *APIStats) WrapTransport(rt http.RoundTripper) http.RoundTripper {
+	return &apiStatsRoundTripper{stats: s, delegate: rt}
+}
+
+// RateLimiter returns a client-side rate limiter for the given QPS and burst
+// that accounts the time spent waiting for a token. Zero values select the
+// client-go defaults; a negative QPS disables rate limiting and returns nil.
+func (s *APIStats) RateLimiter(qps float32, burst int) flowcontrol.RateLimiter {
+	if qps < 0 {
+		return nil
+	}
+	if qps == 0 {
+		qps = restclient.DefaultQPS
+	}
+	if burst == 0 {
+		burst = restclient.DefaultBurst
+	}
+	return &throttleTimer{
+		RateLimiter: flowcontrol.NewTokenBucketRateLimiter(qps, burst),
+		stats:       s,
+	}
+}
+
+// Snapshot returns a copy of the statistics gathered so far.
+func (s *APIStats) Snapshot() APIStats {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	calls := make(map[string]int, len(s.Calls))
+	for k, v := range s.Calls {
+		calls[k] = v
+	}
+	return APIStats{
+		spec:             s.spec,
+		Requests:         s.Requests,
+		Calls:            calls,
+		LatencyHistogram: append([]int(nil), s.LatencyHistogram...),
+		Latency:          s.Latency,
+		ThrottleWait:     s.ThrottleWait,
+	}
+}
+
+func (s *APIStats) observe(ctx context.Context, verb, resource string, code int, latency time.Duration) {
+	bucket := len(APILatencyBuckets)
+	for i, bound := range APILatencyBuckets {
+		if latency <= bound {
+			bucket = i
+			break
+		}
+	}
+
+	s.mu.Lock()
+	s.Requests++
+	s.Calls[verb+" "+resource]++
+	s.LatencyHistogram[bucket]++
+	s.Latency += latency
+	s.mu.Unlock()
+
+	// The spec is only recorded on spans, as a metric attribute it would
+	// create new time series for every spec.
+	attrs := metric.WithAttributes(
+		attribute.String("k8s.verb", verb),
+		attribute.String("k8s.resource", resource),
+		attribute.Int("http.status_code", code),
+	)
+	s.requests.Add(ctx, 1, attrs)
+	s.duration.Record(ctx, latency.Seconds(), attrs)
+}
+
+func (s *APIStats) observeThrottle(wait time.Duration) {
+	s.mu.Lock()
+	s.ThrottleWait += wait
+	s.mu.Unlock()
+}
+
+type apiStatsRoundTripper struct {
+	stats    *APIStats
+	delegate http.RoundTripper
+}
+
+func (rt *apiStatsRoundTripper) RoundTrip(req *http.Request) (*http.Response, error) {
+	verb, resource := requestVerbResource(req)
+
+	ctx, span := otel.Tracer(instrumentationName).Start(req.Context(), verb+" "+resource,
+		trace.WithSpanKind(trace.SpanKindClient),
+		trace.WithAttributes(
+			attribute.String("e2e.spec", rt.stats.spec),
+			attribute.String("k8s.verb", verb),
+			attribute.String("k8s.resource", resource),
+		))
+	defer span.End()
+
+	start := time.Now()
+	resp, err := rt.delegate.RoundTrip(req.WithContext(ctx))
+	latency := time.Since(start)
+
+	code := 0
+	if err != nil {
+		span.RecordError(err)
+		span.SetStatus(codes.Error, err.Error())
+	} else {
+		code = resp.StatusCode
+		span.SetAttributes(attribute.Int("http.status_code", code))
+		if code >= http.StatusBadRequest {
+			span.SetStatus(codes.Error, strconv.Itoa(code))
+		}
+	}
+	rt.stats.observe(ctx, verb, resource, code, latency)
+
+	return resp, err
+}
+
+var namespaceSubresources = map[string]bool{"status": true, "finalize": true}
+
+// requestVerbResource derives the Kubernetes verb and resource of a request
+// from its method and path, e.g. "list pods" for GET /api/v1/namespaces/x/pods.
+func requestVerbResource(req *http.Request) (string, string) {
+	parts := strings.Split(strings.Trim(req.URL.Path, "/"), "/")
+	switch {
+	case len(parts) >= 2 && parts[0] == "api":
+		parts = parts[2:]
+	case len(parts) >= 3 && parts[0] == "apis":
+		parts = parts[3:]
+	default:
+		return strings.ToLower(req.Method), req.URL.Path
+	}
+
+	// namespaces/<ns> prefixes namespaced resources, except for the
+	// subresources of the namespace itself.
+	if len(parts) >= 3 && parts[0] == "namespaces" && !namespaceSubresources[parts[2]] {
+		parts = parts[2:]
+	}
+	if len(parts) == 0 {
+		return strings.ToLower(req.Method), req.URL.Path
+	}
+
+	resource := parts[0]
+	named := len(parts) > 1
+	if len(parts) > 2 {
+		resource += "/" + parts[2]
+	}
+
+	switch req.Method {
+	case http.MethodGet:
+		if req.URL.Query().Get("watch") == "true" {
+			return "watch", resource
+		}
+		if named {
+			return "get", resource
+		}
+		return "list", resource
+	case http.MethodPost:
+		return "create", resource
+	case http.MethodPut:
+		return "update", resource
+	case http.MethodPatch:
+		return "patch", resource
+	case http.MethodDelete:
+		if named {
+			return "delete", resource
+		}
+		return "deletecollection", resource
+	}
+	return strings.ToLower(req.Method), resource
+}
+
+// throttleTimer measures the time spent in the wrapped rate limiter.
+type throttleTimer struct {
+	flowcontrol.RateLimiter
+	stats *APIStats
+}
+
+func (t *throttleTimer) Accept() {
+	start := time.Now()
+	t.RateLimiter.Accept()
+	t.stats.observeThrottle(time.Since(start))
+}
+
+func (t *throttleTimer) Wait(ctx context.Context) error {
+	start := time.Now()
+	err := t.RateLimiter.Wait(ctx)
+	t.stats.observeThrottle(time.Since(start))
+	return err
+}
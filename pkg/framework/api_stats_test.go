@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"net/http"
+	"net/http/httptest"
+	"testing"
+)
+
+func TestRequestVerbResource(t *testing.T) {
+	tests := []struct {
+		method, url    string
+		verb, resource string
+	}{
+		{http.MethodGet, "/api/v1/namespaces/e2e/pods", "list", "pods"},
+		{http.MethodGet, "/api/v1/namespaces/e2e/pods?watch=true", "watch", "pods"},
+		{http.MethodGet, "/api/v1/namespaces/e2e/pods/p", "get", "pods"},
+		{http.MethodPut, "/api/v1/namespaces/e2e/pods/p/status", "update", "pods/status"},
+		{http.MethodDelete, "/apis/batch/v1/namespaces/e2e/jobs", "deletecollection", "jobs"},
+		{http.MethodGet, "/api/v1/namespaces", "list", "namespaces"},
+		{http.MethodDelete, "/api/v1/namespaces/e2e", "delete", "namespaces"},
+		{http.MethodGet, "/api/v1/namespaces/e2e/status", "get", "namespaces/status"},
+		{http.MethodPut, "/api/v1/namespaces/e2e/finalize", "update", "namespaces/finalize"},
+		{http.MethodPatch, "/api/v1/nodes/n/status", "patch", "nodes/status"},
+	}
+	for _, tc := range tests {
+		verb, resource := requestVerbResource(httptest.NewRequest(tc.method, tc.url, nil))
+		if verb != tc.verb || resource != tc.resource {
+			t.Errorf("%s %s: got %q %q, want %q %q", tc.method, tc.url, verb, resource, tc.verb, tc.resource)
+		}
+	}
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"io"
+	"sync"
+
+	helm "github.com/mittwald/go-helm-client"
+	"helm.sh/helm/v3/pkg/action"
+	"helm.sh/helm/v3/pkg/chartutil"
+	kubefake "helm.sh/helm/v3/pkg/kube/fake"
+	"helm.sh/helm/v3/pkg/storage"
+	"helm.sh/helm/v3/pkg/storage/driver"
+	clientset "k8s.io/client-go/kubernetes"
+	"k8s.io/client-go/rest"
+
+	"github.com/NVIDIA/k8s-test-infra/pkg/kubernetes/fakeapi"
+)
+
+// Cluster provides the clients of a cluster that is not reached through a
+// kubeconfig.
+type Cluster interface {
+	// ClientConfig returns a new client config for the cluster.
+	ClientConfig() *rest.Config
+	// HelmClient returns a Helm client for the given namespace.
+	HelmClient(namespace string, debugLog action.DebugLog) (helm.Client, error)
+}
+
+// SimulatedCluster is an in-process Cluster for running suites without a
+// real cluster, e.g. on CI machines without GPUs. Kubernetes objects are
+// served by an in-memory API server without controllers; populate it with
+// simulated GPU nodes and pods, e.g. with kubernetes.CreateGPUFleet and a
+// kubernetes.PodSimulator. Helm renders charts and keeps releases in memory,
+// but does not create their objects.
+type SimulatedCluster struct {
+	server *fakeapi.Server
+
+	mu       sync.Mutex
+	releases map[string]*storage.Storage
+}
+
+// NewSimulatedCluster starts the API server of a simulated cluster. Close it
+// when the suite is done.
+func NewSimulatedCluster() *SimulatedCluster {
+	return &SimulatedCluster{
+		server:   fakeapi.NewServer(),
+		releases: map[string]*storage.Storage{},
+	}
+}
+
+// ClientConfig returns a client config for the API server of the simulated
+// cluster.
+func (c *SimulatedCluster) ClientConfig() *rest.Config {
+	return c.server.Config()
+}
+
+// ClientSet returns a new clientset for the simulated cluster, e.g. to seed
+// it before the suite runs.
+func (c *SimulatedCluster) ClientSet() clientset.Interface {
+	return clientset.NewForConfigOrDie(c.server.Config())
+}
+
+// Server returns the API server of the simulated cluster.
+func (c *SimulatedCluster) Server() *fakeapi.Server {
+	return c.server
+}
+
+// Close stops the API server of the simulated cluster.
+func (c *SimulatedCluster) Close() {
+	c.server.Close()
+}
+
+// HelmClient returns a Helm client whose releases are stored in memory for
+// the lifetime of the cluster. Charts are resolved through the same chart
+// cache as for real clusters, so TestContext.HelmOffline applies.
+func (c *SimulatedCluster) HelmClient(namespace string, debugLog action.DebugLog) (helm.Client, error) {
+	return HelmClients.newClient(helmCacheDir(), namespace, &action.Configuration{
+		Releases:     c.releaseStorage(namespace),
+		KubeClient:   &kubefake.PrintingKubeClient{Out: io.Discard},
+		Capabilities: chartutil.DefaultCapabilities,
+		Log:          debugLog,
+	}, debugLog)
+}
+
+func (c *SimulatedCluster) releaseStorage(namespace string) *storage.Storage {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	s, ok := c.releases[namespace]
+	if !ok {
+		d := driver.NewMemory()
+		d.SetNamespace(namespace)
+		s = storage.Init(d)
+		c.releases[namespace] = s
+	}
+	return s
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"context"
+	"fmt"
+	"sync"
+
+	batchv1 "k8s.io/api/batch/v1"
+	corev1 "k8s.io/api/core/v1"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/labels"
+	"k8s.io/apimachinery/pkg/runtime"
+	"k8s.io/apimachinery/pkg/watch"
+	clientset "k8s.io/client-go/kubernetes"
+	"k8s.io/client-go/rest"
+	"k8s.io/client-go/tools/cache"
+)
+
+var (
+	clusterCachesMu sync.Mutex
+	clusterCaches   = map[string]*ClusterCache{}
+)
+
+// ClusterCache is a set of shared informers for nodes, pods and jobs. Each
+// informer is started on first use and then serves reads from memory for the
+// rest of the process. Objects returned by its listers are shared and must
+// not be modified.
+type ClusterCache struct {
+	cs clientset.Interface
+
+	mu        sync.Mutex
+	informers map[string]cache.SharedIndexInformer
+	stop      chan struct{}
+}
+
+// NewClusterCache returns a ClusterCache reading through cs.
+func NewClusterCache(cs clientset.Interface) *ClusterCache {
+	return &ClusterCache{
+		cs:        cs,
+		informers: map[string]cache.SharedIndexInformer{},
+		stop:      make(chan struct{}),
+	}
+}
+
+// ClusterCache returns the cluster cache of this process. It is shared by all
+// specs and uses its own client, so its API calls are not accounted to the
+// spec that happened to start it.
+func (f *Framework) ClusterCache() (*ClusterCache, error) {
+	clusterCachesMu.Lock()
+	defer clusterCachesMu.Unlock()
+
+	if c, ok := clusterCaches[f.clientConfig.Host]; ok {
+		return c, nil
+	}
+	config := rest.CopyConfig(f.clientConfig)
+	config.WrapTransport = nil
+	cs, err := clientset.NewForConfig(config)
+	if err != nil {
+		return nil, err
+	}
+	c := NewClusterCache(cs)
+	clusterCaches[f.clientConfig.Host] = c
+	return c, nil
+}
+
+// NamespacePods returns a cache-backed lister for the pods of f.Namespace.
+func (f *Framework) NamespacePods(ctx context.Context) (Lister[*corev1.Pod], error) {
+	c, err := f.ClusterCache()
+	if err != nil {
+		return Lister[*corev1.Pod]{}, err
+	}
+	pods, err := c.Pods(ctx)
+	return pods.Namespace(f.Namespace.Name), err
+}
+
+// NamespaceJobs returns a cache-backed lister for the jobs of f.Namespace.
+func (f *Framework) NamespaceJobs(ctx context.Context) (Lister[*batchv1.Job], error) {
+	c, err := f.ClusterCache()
+	if err != nil {
+		return Lister[*batchv1.Job]{}, err
+	}
+	jobs, err := c.Jobs(ctx)
+	return jobs.Namespace(f.Namespace.Name), err
+}
+
+// Nodes returns a lister for all nodes, waiting for the initial sync.
+func (c *ClusterCache) Nodes(ctx context.Context) (Lister[*corev1.Node], error) {
+	nodes := c.cs.CoreV1().Nodes()
+	indexer, err := c.informer(ctx, "nodes", &corev1.Node{}, func(options metav1.ListOptions) (runtime.Object, error) {
+		return nodes.List(context.Background(), options)
+	}, func(options metav1.ListOptions) (watch.Interface, error) {
+		return nodes.Watch(context.Background(), options)
+	})
+	return Lister[*corev1.Node]{indexer: indexer}, err
+}
+
+// Pods returns a lister for the pods of all namespaces, waiting for the
+// initial sync.
+func (c *ClusterCache) Pods(ctx context.Context) (Lister[*corev1.Pod], error) {
+	pods := c.cs.CoreV1().Pods(metav1.NamespaceAll)
+	indexer, err := c.informer(ctx, "pods", &corev1.Pod{}, func(options metav1.ListOptions) (runtime.Object, error) {
+		return pods.List(context.Background(), options)
+	}, func(options metav1.ListOptions) (watch.Interface, error) {
+		return pods.Watch(context.Background(), options)
+	})
+	return Lister[*corev1.Pod]{indexer: indexer}, err
+}
+
+// Jobs returns a lister for the jobs of all namespaces, waiting for the
+// initial sync.
+func (c *ClusterCache) Jobs(ctx context.Context) (Lister[*batchv1.Job], error) {
+	jobs := c.cs.BatchV1().Jobs(metav1.NamespaceAll)
+	indexer, err := c.informer(ctx, "jobs", &batchv1.Job{}, func(options metav1.ListOptions) (runtime.Object, error) {
+		return jobs.List(context.Background(), options)
+	}, func(options metav1.ListOptions) (watch.Interface, error) {
+		return jobs.Watch(context.Background(), options)
+	})
+	return Lister[*batchv1.Job]{indexer: indexer}, err
+}
+
+// Stop stops all informers of the cache.
+func (c *ClusterCache) Stop() {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	select {
+	case <-c.stop:
+	default:
+		close(c.stop)
+	}
+}
+
+func (c *ClusterCache) informer(ctx context.Context, resource string, objType runtime.Object, list cache.ListFunc, watchFn cache.WatchFunc) (cache.Indexer, error) {
+	c.mu.Lock()
+	informer, ok := c.informers[resource]
+	if !ok {
+		informer = cache.NewSharedIndexInformer(
+			&cache.ListWatch{ListFunc: list, WatchFunc: watchFn},
+			objType,
+			0,
+			cache.Indexers{cache.NamespaceIndex: cache.MetaNamespaceIndexFunc},
+		)
+		c.informers[resource] = informer
+		go informer.Run(c.stop)
+	}
+	c.mu.Unlock()
+
+	if !cache.WaitForCacheSync(ctx.Done(), informer.HasSynced) {
+		return informer.GetIndexer(), fmt.Errorf("timed out waiting for %s cache to sync", resource)
+	}
+	return informer.GetIndexer(), nil
+}
+
+// Lister reads objects of one type from a ClusterCache, optionally limited to
+// a namespace.
+type Lister[T runtime.Object] struct {
+	indexer   cache.Indexer
+	namespace string
+}
+
+// Namespace returns a view of the lister limited to the given namespace.
+func (l Lister[T]) Namespace(namespace string) Lister[T] {
+	return Lister[T]{indexer: l.indexer, namespace: namespace}
+}
+
+// List returns the cached objects matching selector.
+func (l Lister[T]) List(selector labels.Selector) ([]T, error) {
+	var out []T
+	err := cache.ListAllByNamespace(l.indexer, l.namespace, selector, func(obj interface{}) {
+		out = append(out, obj.(T))
+	})
+	return out, err
+}
+
+// Get returns the cached object with the given name and whether it exists.
+func (l Lister[T]) Get(name string) (T, bool, error) {
+	var zero T
+	key := name
+	if l.namespace != "" {
+		key = l.namespace + "/" + name
+	}
+	obj, exists, err := l.indexer.GetByKey(key)
+	if err != nil || !exists {
+		return zero, exists, err
+	}
+	return obj.(T), true, nil
+}
@@ -28,7 +28,6 @@ import (
 	"log"
 	"math/rand"
 	"os"
-	"path/filepath"
 	"time"
 
 	helm "github.com/mittwald/go-helm-client"
@@ -41,6 +40,8 @@ import (
 	"k8s.io/apimachinery/pkg/runtime/schema"
 	clientset "k8s.io/client-go/kubernetes"
 	"k8s.io/client-go/rest"
+
+	"github.com/NVIDIA/k8s-test-infra/pkg/kubernetes"
 )
 
 const (
@@ -53,6 +54,9 @@ type Options struct {
 	ClientQPS    float32
 	ClientBurst  int
 	GroupVersion *schema.GroupVersion
+	// Protobuf makes ClientSet use the protobuf wire format for built-in
+	// types. ClientConfig keeps returning JSON for CRD clients such as NFD.
+	Protobuf bool
 }
 
 // Framework supports common operations used by e2e tests; it will keep a client & a namespace for you.
@@ -74,10 +78,18 @@ type Framework struct {
 	clientConfig *rest.Config
 	ClientSet    clientset.Interface
 
+	// APIStats accounts for the API calls of the current spec. It is
+	// attached to the spec report when the spec ends.
+	APIStats *APIStats
+
 	// Helm
-	HelmClient  helm.Client
+	HelmClient helm.Client
+	// HelmLogFile is the Helm log file of this Ginkgo process. It is shared
+	// by all specs of the process and must not be closed by tests.
 	HelmLogFile *os.File
 	HelmLogger  *log.Logger
+	helmLog     *HelmLogSink
+	helmLogFrom int64
 
 	// configuration for framework's client
 	Options Options
@@ -87,6 +99,9 @@ type Framework struct {
 	NamespaceDeletionTimeout time.Duration
 
 	namespacesToDelete []*corev1.Namespace // Some tests have more than one.
+
+	// leakSnapshot is taken before the namespace with TestContext.DetectLeaks.
+	leakSnapshot *ClusterSnapshot
 }
 
 // NewFramework creates a test framework.
@@ -114,6 +129,9 @@ func (f *Framework) ClientConfig() *rest.Config {
 
 // BeforeEach gets a client and makes a namespace.
 func (f *Framework) BeforeEach(ctx context.Context) {
+	// Skip before registering the cleanup, there is nothing to clean up.
+	skipOtherShards()
+
 	// DeferCleanup, in contrast to AfterEach, triggers execution in
 	// first-in-last-out order. This ensures that the framework instance
 	// remains valid as long as possible.
@@ -122,17 +140,44 @@ func (f *Framework) BeforeEach(ctx context.Context) {
 	ginkgo.DeferCleanup(f.AfterEach)
 
 	ginkgo.By("Creating a kubernetes client")
-	config, err := LoadConfig()
-	gomega.Expect(err).NotTo(gomega.HaveOccurred())
+	start := time.Now()
+	f.APIStats = NewAPIStats(specName(ginkgo.CurrentSpecReport()))
+	var config *rest.Config
+	if TestContext.Cluster != nil {
+		config = TestContext.Cluster.ClientConfig()
+	} else {
+		var err error
+		config, err = LoadConfig()
+		gomega.Expect(err).NotTo(gomega.HaveOccurred())
+	}
 
 	config.QPS = f.Options.ClientQPS
 	config.Burst = f.Options.ClientBurst
 	if f.Options.GroupVersion != nil {
 		config.GroupVersion = f.Options.GroupVersion
 	}
+	config.Wrap(f.APIStats.WrapTransport)
 	f.clientConfig = rest.CopyConfig(config)
-	f.ClientSet, err = clientset.NewForConfig(config)
+	clientSetConfig := rest.CopyConfig(config)
+	// The API server of a simulated cluster only speaks JSON.
+	if f.Options.Protobuf && TestContext.Cluster == nil {
+		clientSetConfig = ProtobufConfig(config)
+	}
+	clientSetConfig.RateLimiter = f.APIStats.RateLimiter(config.QPS, config.Burst)
+	var err error
+	f.ClientSet, err = clientset.NewForConfig(clientSetConfig)
 	gomega.Expect(err).NotTo(gomega.HaveOccurred())
+	start = recordPhase(PhaseClient, start)
+
+	if TestContext.DetectLeaks {
+		f.leakSnapshot, err = TakeSnapshot(ctx, f.ClientSet, DefaultLeakResources)
+		if errors.Is(err, kubernetes.ErrNoRESTClient) {
+			ginkgo.By("Skipping leak detection, the clientset can not list raw tables")
+			err = nil
+		}
+		gomega.Expect(err).NotTo(gomega.HaveOccurred())
+		start = recordPhase(PhaseLeakSnapshot, start)
+	}
 
 	if !f.SkipNamespaceCreation {
 		ginkgo.By(fmt.Sprintf("Building a namespace with basename %s", f.BaseName))
@@ -148,30 +193,22 @@ func (f *Framework) BeforeEach(ctx context.Context) {
 		// not guaranteed to be unique, but very likely
 		f.UniqueName = fmt.Sprintf("%s-%08x", f.BaseName, rand.Int31())
 	}
+	start = recordPhase(PhaseNamespace, start)
 
 	// Create a Helm client
 	ginkgo.By("Creating a Helm client")
 
-	err = os.MkdirAll(filepath.Dir(TestContext.HelmLogFile), 0755)
+	f.helmLog, err = helmLog()
 	gomega.Expect(err).To(gomega.BeNil())
 
-	f.HelmLogFile, err = os.OpenFile(TestContext.HelmLogFile, os.O_RDWR|os.O_CREATE|os.O_APPEND, 0666)
-	gomega.Expect(err).To(gomega.BeNil())
-
-	f.HelmLogger = log.New(f.HelmLogFile, fmt.Sprintf("%s\t", f.UniqueName), log.Ldate|log.Ltime)
-	helmRestConf := &helm.RestConfClientOptions{
-		Options: &helm.Options{
-			Namespace:        f.Namespace.Name,
-			RepositoryCache:  "/tmp/.helmcache",
-			RepositoryConfig: "/tmp/.helmrepo",
-			Debug:            true,
-			DebugLog:         f.HelmLogger.Printf,
-		},
-		RestConfig: config,
-	}
+	f.HelmLogFile = f.helmLog.File()
+	f.helmLogFrom = f.helmLog.Flush()
+	f.HelmLogger = log.New(f.helmLog, fmt.Sprintf("%s\t", f.UniqueName), log.Ldate|log.Ltime)
+	start = recordPhase(PhaseHelmLog, start)
 
-	f.HelmClient, err = helm.NewClientFromRestConf(helmRestConf)
+	f.HelmClient, err = newHelmClient(f.clientConfig, f.Namespace.Name, f.HelmLogger.Printf)
 	gomega.Expect(err).NotTo(gomega.HaveOccurred())
+	recordPhase(PhaseHelmClient, start)
 }
 
 // AfterEach deletes the namespace, after reading its events.
@@ -183,12 +220,25 @@ func (f *Framework) AfterEach(ctx context.Context) {
 	// DeleteNamespace at the very end in defer, to avoid any
 	// expectation failures preventing deleting the namespace.
 	defer func() {
+		start := time.Now()
 		var nsDeletionErrors error
+		specNamespaces := make([]string, 0, len(f.namespacesToDelete))
+		for _, ns := range f.namespacesToDelete {
+			specNamespaces = append(specNamespaces, ns.Name)
+		}
 		// Whether to delete namespace is determined by 3 factors: delete-namespace flag, delete-namespace-on-failure flag and the test result
 		// if delete-namespace set to false, namespace will always be preserved.
 		// if delete-namespace is true and delete-namespace-on-failure is false, namespace will be preserved if test failed.
 		if TestContext.DeleteNamespace && (TestContext.DeleteNamespaceOnFailure || !ginkgo.CurrentSpecReport().Failed()) {
+			var deleted []string
 			for _, ns := range f.namespacesToDelete {
+				if TestContext.FastNamespaceTeardown {
+					ginkgo.By(fmt.Sprintf("[Cleanup]\tForce-deleting workloads in namespace %q.", ns.Name))
+					if err := f.forceDeleteWorkloads(ctx, ns.Name); err != nil {
+						nsDeletionErrors = errors.Join(nsDeletionErrors, err)
+					}
+				}
+				deleted = append(deleted, ns.Name)
 				ginkgo.By(fmt.Sprintf("[Cleanup]\tDeleting testing namespace %q.", ns.Name))
 				if err := f.ClientSet.CoreV1().Namespaces().Delete(ctx, ns.Name, metav1.DeleteOptions{}); err != nil {
 					if !apierrors.IsNotFound(err) {
@@ -199,22 +249,61 @@ func (f *Framework) AfterEach(ctx context.Context) {
 				// so that it is not deleted again in the defer block
 				f.namespacesToDelete = f.namespacesToDelete[1:]
 			}
+			start = recordPhase(PhaseNamespaceDeletion, start)
+
+			// Without force deletion the namespaces terminate in the
+			// background, waiting for them is only worth it in fast mode
+			// or to measure how long they take to vanish.
+			if (TestContext.FastNamespaceTeardown || TestContext.MeasureNamespaceVanish) && len(deleted) > 0 {
+				if err := WaitForNamespacesDeleted(ctx, f.ClientSet, deleted, f.namespaceDeletionTimeout()); err != nil {
+					nsDeletionErrors = errors.Join(nsDeletionErrors, err)
+				}
+				recordPhase(PhaseNamespaceVanish, start)
+			}
+		} else {
+			recordPhase(PhaseNamespaceDeletion, start)
+		}
+
+		// The namespaces of the spec may still be terminating, so they
+		// and their contents are not reported.
+		if f.leakSnapshot != nil {
+			start := time.Now()
+			if _, err := CheckLeaks(ctx, f.ClientSet, f.leakSnapshot, specNamespaces...); err != nil {
+				nsDeletionErrors = errors.Join(nsDeletionErrors, fmt.Errorf("error checking for leaks: %w", err))
+			}
+			f.leakSnapshot = nil
+			recordPhase(PhaseLeakCheck, start)
+		}
+
+		// Flush the helm log and record where this spec's lines are,
+		// including the uninstalls of the teardown above.
+		if f.helmLog != nil {
+			start := time.Now()
+			end := f.helmLog.Flush()
+			ginkgo.AddReportEntry(HelmLogReportEntry, HelmLogRange{
+				File:   f.HelmLogFile.Name(),
+				Offset: f.helmLogFrom,
+				Length: end - f.helmLogFrom,
+			}, ginkgo.ReportEntryVisibilityNever)
+			f.helmLog = nil
+			recordPhase(PhaseHelmLogFlush, start)
+		}
+
+		if f.APIStats != nil {
+			ginkgo.AddReportEntry(APIStatsReportEntry, f.APIStats.Snapshot(), ginkgo.ReportEntryVisibilityNever)
 		}
 
 		// Unsetting this is relevant for a following test that uses
 		// the same instance because it might not reach f.BeforeEach
 		// when some other BeforeEach skips the test first.
 		f.Namespace = nil
+		f.APIStats = nil
 		f.clientConfig = nil
 		f.ClientSet = nil
 
 		// if we had errors deleting, report them now.
 		gomega.Expect(nsDeletionErrors).NotTo(gomega.HaveOccurred())
 	}()
-
-	// Close helm log file
-	err := f.HelmLogFile.Close()
-	gomega.Expect(err).To(gomega.BeNil())
 }
 
 // CreateNamespace creates a namespace for e2e testing.
@@ -246,15 +335,27 @@ func (f *Framework) CreateNamespace(ctx context.Context, baseName string, labels
 // DeleteNamespace can be used to delete a namespace
 func (f *Framework) DeleteNamespace(ctx context.Context, name string) {
 	defer func() {
+		if TestContext.FastNamespaceTeardown {
+			gomega.Expect(f.forceDeleteWorkloads(ctx, name)).To(gomega.Succeed())
+		}
 		err := f.ClientSet.CoreV1().Namespaces().Delete(ctx, name, metav1.DeleteOptions{})
 		if err != nil && !apierrors.IsNotFound(err) {
 			gomega.Expect(err).NotTo(gomega.HaveOccurred())
 		}
-		err = WaitForNamespacesDeleted(ctx, f.ClientSet, []string{name}, DefaultNamespaceDeletionTimeout)
+		start := time.Now()
+		err = WaitForNamespacesDeleted(ctx, f.ClientSet, []string{name}, f.namespaceDeletionTimeout())
+		recordPhase(PhaseNamespaceVanish, start)
 		gomega.Expect(err).NotTo(gomega.HaveOccurred())
 	}()
 }
 
+func (f *Framework) namespaceDeletionTimeout() time.Duration {
+	if f.NamespaceDeletionTimeout > 0 {
+		return f.NamespaceDeletionTimeout
+	}
+	return DefaultNamespaceDeletionTimeout
+}
+
 // AddNamespacesToDelete adds one or more namespaces to be deleted when the test
 // completes.
 func (f *Framework) AddNamespacesToDelete(namespaces ...*corev1.Namespace) {
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"context"
+	"path/filepath"
+	"testing"
+
+	helm "github.com/mittwald/go-helm-client"
+	"github.com/onsi/ginkgo/v2"
+	"github.com/onsi/gomega"
+	"helm.sh/helm/v3/pkg/action"
+	corev1 "k8s.io/api/core/v1"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+)
+
+// simulatedNamespace is the test namespace of the spec below, and
+// simulatedChart a chart it installs.
+var simulatedNamespace, simulatedChart string
+
+var _ = ginkgo.Describe("Framework with a simulated cluster", func() {
+	f := NewFramework("simulated")
+
+	ginkgo.It("creates a test namespace", func(ctx context.Context) {
+		gomega.Expect(f.Namespace).NotTo(gomega.BeNil())
+		simulatedNamespace = f.Namespace.Name
+
+		pod := &corev1.Pod{
+			ObjectMeta: metav1.ObjectMeta{Name: "workload"},
+			Spec:       corev1.PodSpec{Containers: []corev1.Container{{Name: "main", Image: "busybox"}}},
+		}
+		_, err := f.ClientSet.CoreV1().Pods(f.Namespace.Name).Create(ctx, pod, metav1.CreateOptions{})
+		gomega.Expect(err).NotTo(gomega.HaveOccurred())
+		_, err = f.HelmClient.InstallOrUpgradeChart(ctx, &helm.ChartSpec{
+			ReleaseName: "workload",
+			ChartName:   simulatedChart,
+			Namespace:   f.Namespace.Name,
+		}, nil)
+		gomega.Expect(err).NotTo(gomega.HaveOccurred())
+	})
+})
+
+// TestFrameworkSimulatedCluster runs the BeforeEach and AfterEach of the
+// framework against a SimulatedCluster, with fast teardown and leak
+// detection.
+func TestFrameworkSimulatedCluster(t *testing.T) {
+	cluster := NewSimulatedCluster()
+	defer cluster.Close()
+
+	saved := TestContext
+	defer func() { TestContext = saved }()
+	TestContext.Cluster = cluster
+	TestContext.DeleteNamespace = true
+	TestContext.FastNamespaceTeardown = true
+	TestContext.DetectLeaks = true
+	TestContext.HelmLogFile = filepath.Join(t.TempDir(), "helm.log")
+	TestContext.HelmCacheDir = t.TempDir()
+	defer CloseHelmLog()
+	simulatedChart = writeChart(t, t.TempDir(), "workload", "a")
+
+	gomega.RegisterFailHandler(ginkgo.Fail)
+	if !ginkgo.RunSpecs(t, "Framework") {
+		return
+	}
+
+	server := cluster.Server()
+	if got := server.Count("POST namespaces"); got != 1 {
+		t.Errorf("got %d namespace creations, want 1", got)
+	}
+	if got := server.Count("DELETE pods"); got != 1 {
+		t.Errorf("got %d pod collection deletions, want 1 of the fast teardown", got)
+	}
+	ctx := context.Background()
+	cs := cluster.ClientSet()
+	if _, err := cs.CoreV1().Namespaces().Get(ctx, simulatedNamespace, metav1.GetOptions{}); err == nil {
+		t.Errorf("namespace %s was not deleted", simulatedNamespace)
+	}
+	client, err := cluster.HelmClient(simulatedNamespace, func(string, ...interface{}) {})
+	if err != nil {
+		t.Fatal(err)
+	}
+	releases, err := client.ListReleasesByStateMask(action.ListAll)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if len(releases) != 0 {
+		t.Errorf("got %d Helm releases after teardown, want none", len(releases))
+	}
+	pods, err := cs.CoreV1().Pods(metav1.NamespaceAll).List(ctx, metav1.ListOptions{})
+	if err != nil {
+		t.Fatal(err)
+	}
+	if len(pods.Items) != 0 {
+		t.Errorf("got %d pods after teardown, want none", len(pods.Items))
+	}
+}
@@ -0,0 +1,519 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"context"
+	"crypto/sha256"
+	"encoding/hex"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+	"time"
+
+	helm "github.com/mittwald/go-helm-client"
+	"github.com/onsi/ginkgo/v2"
+	"github.com/spf13/pflag"
+	"helm.sh/helm/v3/pkg/action"
+	"helm.sh/helm/v3/pkg/chart"
+	"helm.sh/helm/v3/pkg/cli"
+	"helm.sh/helm/v3/pkg/getter"
+	"helm.sh/helm/v3/pkg/helmpath"
+	"helm.sh/helm/v3/pkg/registry"
+	"helm.sh/helm/v3/pkg/release"
+	"helm.sh/helm/v3/pkg/repo"
+	"k8s.io/apimachinery/pkg/api/meta"
+	"k8s.io/client-go/discovery"
+	"k8s.io/client-go/discovery/cached/memory"
+	"k8s.io/client-go/rest"
+	"k8s.io/client-go/restmapper"
+	"k8s.io/client-go/tools/clientcmd"
+)
+
+// HelmClients is the per-process Helm client factory used by the framework.
+var HelmClients = &HelmClientFactory{}
+
+// HelmClientFactory hands out Helm clients that share discovery data, the
+// repository configuration and a chart cache within a process, so that
+// creating a client per spec is cheap.
+type HelmClientFactory struct {
+	mu        sync.Mutex
+	discovery map[string]discovery.CachedDiscoveryInterface
+	mappers   map[string]meta.RESTMapper
+	bases     map[string]*helm.HelmClient
+	charts    *ChartCache
+}
+
+// NewClient returns a Helm client for the given namespace. Discovery is done
+// once per cluster and process; charts are resolved through the ChartCache
+// rooted at TestContext.HelmCacheDir.
+func (h *HelmClientFactory) NewClient(config *rest.Config, namespace string, debugLog action.DebugLog) (helm.Client, error) {
+	getter, err := h.restClientGetter(config, namespace)
+	if err != nil {
+		return nil, err
+	}
+	actionConfig := new(action.Configuration)
+	if err := actionConfig.Init(getter, namespace, os.Getenv("HELM_DRIVER"), debugLog); err != nil {
+		return nil, fmt.Errorf("error initializing Helm action config: %w", err)
+	}
+	return h.newClient(helmCacheDir(), namespace, actionConfig, debugLog)
+}
+
+// newClient returns a Helm client with the given action config. The
+// constructors of go-helm-client initialize an action config of their own,
+// so clients are copied from a base client that is built once per cache
+// directory and process.
+func (h *HelmClientFactory) newClient(cacheDir, namespace string, actionConfig *action.Configuration, debugLog action.DebugLog) (helm.Client, error) {
+	base, err := h.baseClient(cacheDir)
+	if err != nil {
+		return nil, err
+	}
+	settings, err := helmSettings(base.Settings, namespace)
+	if err != nil {
+		return nil, err
+	}
+	if actionConfig.RegistryClient == nil {
+		actionConfig.RegistryClient = base.ActionConfig.RegistryClient
+	}
+
+	client := *base
+	client.Settings = settings
+	client.ActionConfig = actionConfig
+	client.DebugLog = debugLog
+	return &cachingHelmClient{Client: &client, charts: h.chartCache(cacheDir)}, nil
+}
+
+func (h *HelmClientFactory) baseClient(cacheDir string) (*helm.HelmClient, error) {
+	h.mu.Lock()
+	defer h.mu.Unlock()
+
+	if base, ok := h.bases[cacheDir]; ok {
+		return base, nil
+	}
+	client, err := helm.New(helmOptions(cacheDir))
+	if err != nil {
+		return nil, err
+	}
+	base, ok := client.(*helm.HelmClient)
+	if !ok {
+		return nil, fmt.Errorf("unexpected Helm client type %T", client)
+	}
+	if h.bases == nil {
+		h.bases = map[string]*helm.HelmClient{}
+	}
+	h.bases[cacheDir] = base
+	return base, nil
+}
+
+// helmSettings returns a copy of the settings of a base client for the given
+// namespace. The namespace of cli.EnvSettings can only be set through its
+// flags.
+func helmSettings(base *cli.EnvSettings, namespace string) (*cli.EnvSettings, error) {
+	settings := cli.New()
+	flags := pflag.NewFlagSet("", pflag.ContinueOnError)
+	settings.AddFlags(flags)
+	if err := flags.Parse([]string{"--namespace", namespace}); err != nil {
+		return nil, err
+	}
+	settings.RepositoryConfig = base.RepositoryConfig
+	settings.RepositoryCache = base.RepositoryCache
+	settings.Debug = base.Debug
+	return settings, nil
+}
+
+// newHelmClient returns a Helm client for the cluster under test: the
+// simulated TestContext.Cluster if one is set, the cluster of config
+// otherwise.
+func newHelmClient(config *rest.Config, namespace string, debugLog action.DebugLog) (helm.Client, error) {
+	if TestContext.Cluster != nil {
+		return TestContext.Cluster.HelmClient(namespace, debugLog)
+	}
+	return HelmClients.NewClient(config, namespace, debugLog)
+}
+
+func helmCacheDir() string {
+	if TestContext.HelmCacheDir == "" {
+		return filepath.Join(os.TempDir(), "e2e-helm-cache")
+	}
+	return TestContext.HelmCacheDir
+}
+
+func helmOptions(cacheDir string) *helm.Options {
+	// Repository configuration and indexes are written non-atomically by
+	// Helm, so every Ginkgo process keeps its own copy.
+	process := ginkgo.GinkgoParallelProcess()
+	return &helm.Options{
+		RepositoryCache:  filepath.Join(cacheDir, fmt.Sprintf("repository-%d", process)),
+		RepositoryConfig: filepath.Join(cacheDir, fmt.Sprintf("repositories-%d.yaml", process)),
+		Debug:            true,
+	}
+}
+
+func (h *HelmClientFactory) restClientGetter(config *rest.Config, namespace string) (*restClientGetter, error) {
+	h.mu.Lock()
+	defer h.mu.Unlock()
+
+	if h.discovery == nil {
+		h.discovery = map[string]discovery.CachedDiscoveryInterface{}
+		h.mappers = map[string]meta.RESTMapper{}
+	}
+	dc, ok := h.discovery[config.Host]
+	if !ok {
+		// Discovery outlives the spec that triggered it, so keep it out
+		// of that spec's API accounting.
+		discoveryConfig := rest.CopyConfig(config)
+		discoveryConfig.WrapTransport = nil
+		discoveryConfig.RateLimiter = nil
+		discoveryConfig.Burst = 100
+		client, err := discovery.NewDiscoveryClientForConfig(discoveryConfig)
+		if err != nil {
+			return nil, fmt.Errorf("error creating discovery client: %w", err)
+		}
+		dc = memory.NewMemCacheClient(client)
+		mapper := restmapper.NewDeferredDiscoveryRESTMapper(dc)
+		h.discovery[config.Host] = dc
+		h.mappers[config.Host] = restmapper.NewShortcutExpander(mapper, dc, nil)
+	}
+
+	return &restClientGetter{
+		config:    config,
+		namespace: namespace,
+		discovery: dc,
+		mapper:    h.mappers[config.Host],
+	}, nil
+}
+
+func (h *HelmClientFactory) chartCache(dir string) *ChartCache {
+	h.mu.Lock()
+	defer h.mu.Unlock()
+
+	if h.charts == nil || h.charts.dir != dir {
+		h.charts = NewChartCache(dir, TestContext.HelmOffline)
+	}
+	return h.charts
+}
+
+// restClientGetter serves Helm a per-spec REST config together with
+// process-wide discovery data.
+type restClientGetter struct {
+	config    *rest.Config
+	namespace string
+	discovery discovery.CachedDiscoveryInterface
+	mapper    meta.RESTMapper
+}
+
+func (g *restClientGetter) ToRESTConfig() (*rest.Config, error) {
+	return rest.CopyConfig(g.config), nil
+}
+
+func (g *restClientGetter) ToDiscoveryClient() (discovery.CachedDiscoveryInterface, error) {
+	return g.discovery, nil
+}
+
+func (g *restClientGetter) ToRESTMapper() (meta.RESTMapper, error) {
+	return g.mapper, nil
+}
+
+func (g *restClientGetter) ToRawKubeConfigLoader() clientcmd.ClientConfig {
+	loadingRules := clientcmd.NewDefaultClientConfigLoadingRules()
+	loadingRules.DefaultClientConfig = &clientcmd.DefaultClientConfig
+
+	overrides := &clientcmd.ConfigOverrides{ClusterDefaults: clientcmd.ClusterDefaults}
+	overrides.Context.Namespace = g.namespace
+
+	return clientcmd.NewNonInteractiveDeferredLoadingClientConfig(loadingRules, overrides)
+}
+
+// ChartCache is a store of chart archives shared by all Ginkgo processes on
+// a host. Entries are keyed by repository URL, chart name and version, not by
+// content: a chart version republished under the same reference is served
+// from the cache until the cache directory is removed. Entries are published
+// with an atomic rename, so concurrent writers never expose partial archives.
+type ChartCache struct {
+	dir     string
+	offline bool
+
+	mu    sync.Mutex
+	repos map[string]repo.Entry
+	keys  map[string]*sync.Mutex
+}
+
+// chartIndexFreshness is how long a cached repository index is served before
+// it is downloaded again.
+const chartIndexFreshness = 10 * time.Minute
+
+// NewChartCache returns a chart cache rooted at dir. In offline mode charts
+// are only served from the cache and repository updates are skipped.
+func NewChartCache(dir string, offline bool) *ChartCache {
+	return &ChartCache{
+		dir:     dir,
+		offline: offline,
+		repos:   map[string]repo.Entry{},
+		keys:    map[string]*sync.Mutex{},
+	}
+}
+
+// AddRepo records a chart repository so that "repo/chart" references can be
+// resolved to cache entries and its index can be shared.
+func (c *ChartCache) AddRepo(entry repo.Entry) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	c.repos[entry.Name] = entry
+}
+
+// UpdateIndexes writes the indexes of the known repositories to repoCache,
+// the repository cache of a Helm client. Indexes are shared by all processes
+// through the cache, keyed by repository URL, and are downloaded again once
+// they are older than chartIndexFreshness. In offline mode cached indexes are
+// installed regardless of their age and nothing is downloaded.
+func (c *ChartCache) UpdateIndexes(repoCache string, providers getter.Providers) error {
+	c.mu.Lock()
+	entries := make([]repo.Entry, 0, len(c.repos))
+	for _, entry := range c.repos {
+		entries = append(entries, entry)
+	}
+	c.mu.Unlock()
+
+	for _, entry := range entries {
+		if registry.IsOCI(entry.URL) {
+			continue
+		}
+		if err := c.updateIndex(entry, repoCache, providers); err != nil {
+			return fmt.Errorf("error updating index of repository %s: %w", entry.Name, err)
+		}
+	}
+	return nil
+}
+
+func (c *ChartCache) updateIndex(entry repo.Entry, repoCache string, providers getter.Providers) error {
+	sum := sha256.Sum256([]byte(strings.TrimSuffix(entry.URL, "/")))
+	key := hex.EncodeToString(sum[:])
+	shared := filepath.Join(c.dir, "indexes", key+".yaml")
+	local := filepath.Join(repoCache, helmpath.CacheIndexFile(entry.Name))
+
+	// Other processes are handled by the atomic rename of copyAtomic;
+	// at worst they download the same index concurrently.
+	lock := c.keyLock("index-" + key)
+	lock.Lock()
+	defer lock.Unlock()
+
+	info, err := os.Stat(shared)
+	if err == nil && (c.offline || time.Since(info.ModTime()) < chartIndexFreshness) {
+		if err := os.MkdirAll(repoCache, 0755); err != nil {
+			return err
+		}
+		return copyAtomic(shared, local)
+	}
+	if c.offline {
+		return nil
+	}
+
+	chartRepo, err := repo.NewChartRepository(&entry, providers)
+	if err != nil {
+		return err
+	}
+	chartRepo.CachePath = repoCache
+	downloaded, err := chartRepo.DownloadIndexFile()
+	if err != nil {
+		return err
+	}
+	if err := os.MkdirAll(filepath.Dir(shared), 0755); err != nil {
+		return err
+	}
+	return copyAtomic(downloaded, shared)
+}
+
+// Locate returns a local path for the given chart reference, downloading it
+// through client on a cache miss. Local charts and references without a
+// version are not cached and are returned unchanged.
+func (c *ChartCache) Locate(client helm.Client, chartName, version string) (string, error) {
+	if _, err := os.Stat(chartName); err == nil {
+		return chartName, nil
+	}
+	if version == "" {
+		if c.offline {
+			return "", fmt.Errorf("chart %q needs a version to be resolved offline", chartName)
+		}
+		return chartName, nil
+	}
+
+	key := c.key(chartName, version)
+	entryDir := filepath.Join(c.dir, "charts", key)
+	archive := filepath.Join(entryDir, fmt.Sprintf("%s-%s.tgz", filepath.Base(chartName), version))
+	if _, err := os.Stat(archive); err == nil {
+		return archive, nil
+	}
+	if c.offline {
+		return "", fmt.Errorf("chart %s@%s is not cached in %s and offline mode is enabled", chartName, version, c.dir)
+	}
+
+	// Avoid downloading the same chart twice from within this process;
+	// other processes are handled by the atomic rename below.
+	lock := c.keyLock(key)
+	lock.Lock()
+	defer lock.Unlock()
+	if _, err := os.Stat(archive); err == nil {
+		return archive, nil
+	}
+
+	_, downloaded, err := client.GetChart(chartName, &action.ChartPathOptions{Version: version})
+	if err != nil {
+		return "", fmt.Errorf("error downloading chart %s@%s: %w", chartName, version, err)
+	}
+	if err := os.MkdirAll(entryDir, 0755); err != nil {
+		return "", fmt.Errorf("error creating chart cache entry: %w", err)
+	}
+	if err := copyAtomic(downloaded, archive); err != nil {
+		return "", fmt.Errorf("error caching chart %s@%s: %w", chartName, version, err)
+	}
+	return archive, nil
+}
+
+// key returns the cache key of a chart reference: a hash of the repository
+// URL, or the reference itself for OCI and unknown repositories, the chart
+// name and the version.
+func (c *ChartCache) key(chartName, version string) string {
+	source := chartName
+	if repoName, name, ok := strings.Cut(chartName, "/"); ok && !strings.Contains(repoName, ":") {
+		c.mu.Lock()
+		entry, known := c.repos[repoName]
+		c.mu.Unlock()
+		if known {
+			source = strings.TrimSuffix(entry.URL, "/") + "/" + name
+		}
+	}
+	sum := sha256.Sum256([]byte(source + "@" + version))
+	return hex.EncodeToString(sum[:])
+}
+
+func (c *ChartCache) keyLock(key string) *sync.Mutex {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	lock, ok := c.keys[key]
+	if !ok {
+		lock = &sync.Mutex{}
+		c.keys[key] = lock
+	}
+	return lock
+}
+
+// copyAtomic copies src to dst through a temporary file in dst's directory.
+func copyAtomic(src, dst string) error {
+	in, err := os.Open(src)
+	if err != nil {
+		return err
+	}
+	defer in.Close()
+
+	tmp, err := os.CreateTemp(filepath.Dir(dst), ".tmp-")
+	if err != nil {
+		return err
+	}
+	defer os.Remove(tmp.Name())
+
+	if _, err := io.Copy(tmp, in); err != nil {
+		tmp.Close()
+		return err
+	}
+	if err := tmp.Close(); err != nil {
+		return err
+	}
+	return os.Rename(tmp.Name(), dst)
+}
+
+// cachingHelmClient resolves chart references through a ChartCache before
+// delegating to the wrapped client.
+type cachingHelmClient struct {
+	helm.Client
+	charts *ChartCache
+}
+
+func (c *cachingHelmClient) resolve(spec *helm.ChartSpec) (*helm.ChartSpec, error) {
+	path, err := c.charts.Locate(c.Client, spec.ChartName, spec.Version)
+	if err != nil {
+		return nil, err
+	}
+	resolved := *spec
+	resolved.ChartName = path
+	return &resolved, nil
+}
+
+// GetChart loads a chart through the ChartCache.
+func (c *cachingHelmClient) GetChart(chartName string, options *action.ChartPathOptions) (*chart.Chart, string, error) {
+	if options == nil {
+		options = &action.ChartPathOptions{}
+	}
+	path, err := c.charts.Locate(c.Client, chartName, options.Version)
+	if err != nil {
+		return nil, "", err
+	}
+	return c.Client.GetChart(path, options)
+}
+
+// AddOrUpdateChartRepo records the repository in the ChartCache and in the
+// repository configuration, which the clients of a process share.
+func (c *cachingHelmClient) AddOrUpdateChartRepo(entry repo.Entry) error {
+	c.charts.AddRepo(entry)
+	if c.charts.offline {
+		return nil
+	}
+	lock := c.charts.keyLock("repositories")
+	lock.Lock()
+	defer lock.Unlock()
+	return c.Client.AddOrUpdateChartRepo(entry)
+}
+
+// UpdateChartRepos refreshes the repository indexes through the ChartCache
+// instead of downloading them for every client.
+func (c *cachingHelmClient) UpdateChartRepos() error {
+	return c.charts.UpdateIndexes(c.GetSettings().RepositoryCache, c.GetProviders())
+}
+
+func (c *cachingHelmClient) InstallOrUpgradeChart(ctx context.Context, spec *helm.ChartSpec, opts *helm.GenericHelmOptions) (*release.Release, error) {
+	resolved, err := c.resolve(spec)
+	if err != nil {
+		return nil, err
+	}
+	return c.Client.InstallOrUpgradeChart(ctx, resolved, opts)
+}
+
+func (c *cachingHelmClient) InstallChart(ctx context.Context, spec *helm.ChartSpec, opts *helm.GenericHelmOptions) (*release.Release, error) {
+	resolved, err := c.resolve(spec)
+	if err != nil {
+		return nil, err
+	}
+	return c.Client.InstallChart(ctx, resolved, opts)
+}
+
+func (c *cachingHelmClient) UpgradeChart(ctx context.Context, spec *helm.ChartSpec, opts *helm.GenericHelmOptions) (*release.Release, error) {
+	resolved, err := c.resolve(spec)
+	if err != nil {
+		return nil, err
+	}
+	return c.Client.UpgradeChart(ctx, resolved, opts)
+}
+
+func (c *cachingHelmClient) TemplateChart(spec *helm.ChartSpec, options *helm.HelmTemplateOptions) ([]byte, error) {
+	resolved, err := c.resolve(spec)
+	if err != nil {
+		return nil, err
+	}
+	return c.Client.TemplateChart(resolved, options)
+}
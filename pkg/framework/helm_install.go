@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"context"
+	"errors"
+	"fmt"
+	"sync"
+	"time"
+
+	helm "github.com/mittwald/go-helm-client"
+	"helm.sh/helm/v3/pkg/action"
+	"helm.sh/helm/v3/pkg/release"
+	clientset "k8s.io/client-go/kubernetes"
+	"k8s.io/client-go/rest"
+
+	"github.com/NVIDIA/k8s-test-infra/pkg/framework/waiter"
+)
+
+// ReleaseReadyFunc blocks until an installed release is ready for its
+// dependents.
+type ReleaseReadyFunc func(ctx context.Context, cs clientset.Interface, rel *release.Release) error
+
+// HelmRelease is a node of the release graph installed by InstallReleases.
+type HelmRelease struct {
+	Spec *helm.ChartSpec
+	// DependsOn lists the release names that must be ready before this
+	// release is installed.
+	DependsOn []string
+	// Ready overrides the readiness check, which by default waits for the
+	// Deployments and DaemonSets labelled with the release instance.
+	Ready ReleaseReadyFunc
+}
+
+// ReleaseTiming records when a release was installed and became ready,
+// relative to the start of InstallReleases.
+type ReleaseTiming struct {
+	Start   time.Duration `json:"start"`
+	Install time.Duration `json:"install"`
+	Ready   time.Duration `json:"ready"`
+	End     time.Duration `json:"end"`
+}
+
+// InstallReport summarizes a graph installation.
+type InstallReport struct {
+	Releases map[string]ReleaseTiming `json:"releases"`
+	// CriticalPath is the chain of releases that determined the total time.
+	CriticalPath []string      `json:"criticalPath"`
+	Total        time.Duration `json:"total"`
+}
+
+// InstallReleases installs the given releases into the framework namespace
+// unless their spec names another one. The specs of the caller are not
+// modified. See InstallReleases.
+func (f *Framework) InstallReleases(ctx context.Context, releases ...HelmRelease) (*InstallReport, error) {
+	defaulted := make([]HelmRelease, len(releases))
+	for i, r := range releases {
+		if r.Spec.Namespace == "" {
+			if f.Namespace == nil {
+				return nil, fmt.Errorf("release %q has no namespace and the framework created none", r.Spec.ReleaseName)
+			}
+			spec := *r.Spec
+			spec.Namespace = f.Namespace.Name
+			r.Spec = &spec
+		}
+		defaulted[i] = r
+	}
+	return InstallReleases(ctx, f.clientConfig, f.ClientSet, f.HelmLogger.Printf, defaulted...)
+}
+
+// InstallReleases installs a graph of Helm releases. Releases without pending
+// dependencies are installed concurrently; a release is installed once all
+// of its dependencies are ready. The first failure cancels the remaining
+// installations.
+func InstallReleases(ctx context.Context, config *rest.Config, cs clientset.Interface, debugLog action.DebugLog, releases ...HelmRelease) (*InstallReport, error) {
+	nodes := make(map[string]*HelmRelease, len(releases))
+	for i := range releases {
+		name := releases[i].Spec.ReleaseName
+		if _, ok := nodes[name]; ok {
+			return nil, fmt.Errorf("duplicate release %q", name)
+		}
+		nodes[name] = &releases[i]
+	}
+	if err := checkReleaseGraph(nodes); err != nil {
+		return nil, err
+	}
+
+	ctx, cancel := context.WithCancel(ctx)
+	defer cancel()
+
+	begin := time.Now()
+	done := make(map[string]chan struct{}, len(nodes))
+	for name := range nodes {
+		done[name] = make(chan struct{})
+	}
+
+	var (
+		mu      sync.Mutex
+		errs    error
+		timings = make(map[string]ReleaseTiming, len(nodes))
+		wg      sync.WaitGroup
+	)
+	fail := func(err error) {
+		mu.Lock()
+		errs = errors.Join(errs, err)
+		mu.Unlock()
+		cancel()
+	}
+
+	for name, node := range nodes {
+		wg.Add(1)
+		go func(name string, node *HelmRelease) {
+			defer wg.Done()
+			defer close(done[name])
+
+			for _, dep := range node.DependsOn {
+				select {
+				case <-done[dep]:
+				case <-ctx.Done():
+					return
+				}
+			}
+			if ctx.Err() != nil {
+				return
+			}
+
+			var timing ReleaseTiming
+			timing.Start = time.Since(begin)
+			client, err := newHelmClient(config, node.Spec.Namespace, debugLog)
+			if err != nil {
+				fail(fmt.Errorf("error creating Helm client for %s: %w", name, err))
+				return
+			}
+			rel, err := client.InstallOrUpgradeChart(ctx, node.Spec, nil)
+			if err != nil {
+				fail(fmt.Errorf("error installing %s: %w", name, err))
+				return
+			}
+			timing.Install = time.Since(begin) - timing.Start
+
+			ready := node.Ready
+			if ready == nil {
+				ready = releaseWorkloadsReady
+			}
+			if err := ready(ctx, cs, rel); err != nil {
+				fail(fmt.Errorf("error waiting for %s: %w", name, err))
+				return
+			}
+			timing.End = time.Since(begin)
+			timing.Ready = timing.End - timing.Start - timing.Install
+
+			mu.Lock()
+			timings[name] = timing
+			mu.Unlock()
+		}(name, node)
+	}
+	wg.Wait()
+
+	if errs != nil {
+		return nil, errs
+	}
+	if err := ctx.Err(); err != nil {
+		return nil, err
+	}
+
+	report := &InstallReport{Releases: timings}
+	report.CriticalPath, report.Total = criticalPath(nodes, timings)
+	return report, nil
+}
+
+// checkReleaseGraph rejects unknown dependencies and dependency cycles.
+func checkReleaseGraph(nodes map[string]*HelmRelease) error {
+	pending := make(map[string]int, len(nodes))
+	dependents := make(map[string][]string, len(nodes))
+	for name, node := range nodes {
+		for _, dep := range node.DependsOn {
+			if _, ok := nodes[dep]; !ok {
+				return fmt.Errorf("release %q depends on unknown release %q", name, dep)
+			}
+			dependents[dep] = append(dependents[dep], name)
+		}
+		pending[name] = len(node.DependsOn)
+	}
+
+	var queue []string
+	for name, n := range pending {
+		if n == 0 {
+			queue = append(queue, name)
+		}
+	}
+	visited := 0
+	for len(queue) > 0 {
+		name := queue[0]
+		queue = queue[1:]
+		visited++
+		for _, d := range dependents[name] {
+			pending[d]--
+			if pending[d] == 0 {
+				queue = append(queue, d)
+			}
+		}
+	}
+	if visited != len(nodes) {
+		return fmt.Errorf("release dependencies contain a cycle")
+	}
+	return nil
+}
+
+// criticalPath walks back from the release that finished last, following
+// the dependency that finished last at every step.
+func criticalPath(nodes map[string]*HelmRelease, timings map[string]ReleaseTiming) ([]string, time.Duration) {
+	last := ""
+	for name, t := range timings {
+		if last == "" || t.End > timings[last].End {
+			last = name
+		}
+	}
+	if last == "" {
+		return nil, 0
+	}
+
+	var path []string
+	for name := last; name != ""; {
+		path = append([]string{name}, path...)
+		next := ""
+		for _, dep := range nodes[name].DependsOn {
+			if next == "" || timings[dep].End > timings[next].End {
+				next = dep
+			}
+		}
+		name = next
+	}
+	return path, timings[last].End
+}
+
+// releaseWorkloadsReady waits for the Deployments and DaemonSets of a release
+// to be rolled out.
+func releaseWorkloadsReady(ctx context.Context, cs clientset.Interface, rel *release.Release) error {
+	selector := "app.kubernetes.io/instance=" + rel.Name
+	if err := waiter.Deployments(ctx, cs, rel.Namespace, selector, waiter.DeploymentAvailable); err != nil {
+		return err
+	}
+	return waiter.DaemonSets(ctx, cs, rel.Namespace, selector, waiter.DaemonSetRolledOut)
+}
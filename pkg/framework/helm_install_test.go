@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"context"
+	"io"
+	"log"
+	"reflect"
+	"strings"
+	"testing"
+	"time"
+
+	helm "github.com/mittwald/go-helm-client"
+	"helm.sh/helm/v3/pkg/release"
+	corev1 "k8s.io/api/core/v1"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	clientset "k8s.io/client-go/kubernetes"
+)
+
+func TestCheckReleaseGraph(t *testing.T) {
+	tests := []struct {
+		name    string
+		deps    map[string][]string
+		wantErr string
+	}{
+		{"independent", map[string][]string{"a": nil, "b": nil}, ""},
+		{"diamond", map[string][]string{"a": nil, "b": {"a"}, "c": {"a"}, "d": {"b", "c"}}, ""},
+		{"unknown dependency", map[string][]string{"a": {"missing"}}, "unknown release"},
+		{"self cycle", map[string][]string{"a": {"a"}}, "cycle"},
+		{"cycle", map[string][]string{"a": nil, "b": {"a", "d"}, "c": {"b"}, "d": {"c"}}, "cycle"},
+	}
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			nodes := map[string]*HelmRelease{}
+			for name, deps := range tt.deps {
+				nodes[name] = &HelmRelease{Spec: &helm.ChartSpec{ReleaseName: name}, DependsOn: deps}
+			}
+			err := checkReleaseGraph(nodes)
+			if tt.wantErr == "" && err != nil {
+				t.Fatalf("unexpected error: %v", err)
+			}
+			if tt.wantErr != "" && (err == nil || !strings.Contains(err.Error(), tt.wantErr)) {
+				t.Fatalf("got error %v, want %q", err, tt.wantErr)
+			}
+		})
+	}
+}
+
+// TestInstallReleases installs a release graph into a simulated cluster and
+// checks that dependents start after their dependencies are ready, and the
+// reported critical path.
+func TestInstallReleases(t *testing.T) {
+	saved := TestContext
+	defer func() { TestContext = saved }()
+	cluster := NewSimulatedCluster()
+	defer cluster.Close()
+	TestContext.Cluster = cluster
+	TestContext.HelmCacheDir = t.TempDir()
+	chart := writeChart(t, t.TempDir(), "app", "a")
+
+	readyAfter := func(d time.Duration) ReleaseReadyFunc {
+		return func(ctx context.Context, _ clientset.Interface, _ *release.Release) error {
+			select {
+			case <-time.After(d):
+				return nil
+			case <-ctx.Done():
+				return ctx.Err()
+			}
+		}
+	}
+	newRelease := func(name string, ready ReleaseReadyFunc, deps ...string) HelmRelease {
+		return HelmRelease{
+			Spec:      &helm.ChartSpec{ReleaseName: name, ChartName: chart, Namespace: "graph"},
+			DependsOn: deps,
+			Ready:     ready,
+		}
+	}
+	releases := []HelmRelease{
+		newRelease("base", readyAfter(100*time.Millisecond)),
+		newRelease("side", readyAfter(0)),
+		newRelease("slow", readyAfter(100*time.Millisecond), "base"),
+		newRelease("fast", readyAfter(0), "base"),
+		// The default readiness check, the cluster has no workloads.
+		newRelease("top", nil, "side", "slow", "fast"),
+	}
+
+	report, err := InstallReleases(context.Background(), cluster.ClientConfig(), cluster.ClientSet(), func(string, ...interface{}) {}, releases...)
+	if err != nil {
+		t.Fatal(err)
+	}
+	for _, r := range releases {
+		for _, dep := range r.DependsOn {
+			if start, end := report.Releases[r.Spec.ReleaseName].Start, report.Releases[dep].End; start < end {
+				t.Errorf("%s started at %v, before %s was ready at %v", r.Spec.ReleaseName, start, dep, end)
+			}
+		}
+	}
+	if want := []string{"base", "slow", "top"}; !reflect.DeepEqual(report.CriticalPath, want) {
+		t.Errorf("got critical path %v, want %v", report.CriticalPath, want)
+	}
+	if report.Total != report.Releases["top"].End {
+		t.Errorf("got total %v, want the end of top %v", report.Total, report.Releases["top"].End)
+	}
+
+	releases[0].DependsOn = []string{"top"}
+	if _, err := InstallReleases(context.Background(), cluster.ClientConfig(), cluster.ClientSet(), func(string, ...interface{}) {}, releases...); err == nil || !strings.Contains(err.Error(), "cycle") {
+		t.Errorf("got error %v for a cyclic graph, want a cycle error", err)
+	}
+}
+
+func TestFrameworkInstallReleasesNamespace(t *testing.T) {
+	saved := TestContext
+	defer func() { TestContext = saved }()
+	cluster := NewSimulatedCluster()
+	defer cluster.Close()
+	TestContext.Cluster = cluster
+	TestContext.HelmCacheDir = t.TempDir()
+
+	spec := &helm.ChartSpec{ReleaseName: "app", ChartName: writeChart(t, t.TempDir(), "app", "a")}
+	f := &Framework{
+		clientConfig: cluster.ClientConfig(),
+		ClientSet:    cluster.ClientSet(),
+		HelmLogger:   log.New(io.Discard, "", 0),
+	}
+	if _, err := f.InstallReleases(context.Background(), HelmRelease{Spec: spec}); err == nil {
+		t.Fatal("installed a release without a namespace")
+	}
+
+	f.Namespace = &corev1.Namespace{ObjectMeta: metav1.ObjectMeta{Name: "test-ns"}}
+	if _, err := f.InstallReleases(context.Background(), HelmRelease{Spec: spec}); err != nil {
+		t.Fatal(err)
+	}
+	if spec.Namespace != "" {
+		t.Errorf("the spec of the caller was modified, namespace %q", spec.Namespace)
+	}
+	client, err := cluster.HelmClient("test-ns", func(string, ...interface{}) {})
+	if err != nil {
+		t.Fatal(err)
+	}
+	if _, err := client.GetRelease("app"); err != nil {
+		t.Errorf("release not installed into the framework namespace: %v", err)
+	}
+}
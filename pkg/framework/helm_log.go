@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"bufio"
+	"fmt"
+	"os"
+	"path/filepath"
+	"sync"
+
+	"github.com/onsi/ginkgo/v2"
+)
+
+// HelmLogReportEntry is the name of the report entry locating the Helm log
+// lines of a spec.
+const HelmLogReportEntry = "helm log"
+
+const helmLogQueueSize = 1024
+
+// HelmLogRange locates the Helm log lines written during a spec, so they can
+// be read with a single seek instead of scanning the whole file.
+type HelmLogRange struct {
+	File   string `json:"file"`
+	Offset int64  `json:"offset"`
+	Length int64  `json:"length"`
+}
+
+var (
+	helmLogMu   sync.Mutex
+	helmLogSink *HelmLogSink
+)
+
+// HelmLogSink is a buffered, asynchronous log writer. Writes are queued and
+// written by a single goroutine, so Helm debug logging never waits on disk.
+// Once maxBytes have been written, further lines are dropped.
+type HelmLogSink struct {
+	file     *os.File
+	maxBytes int64
+
+	queue chan helmLogEntry
+	done  chan struct{}
+}
+
+type helmLogEntry struct {
+	line  []byte
+	flush chan int64
+}
+
+// NewHelmLogSink opens path for appending and starts the writer goroutine.
+// A maxBytes of zero disables the size cap.
+func NewHelmLogSink(path string, maxBytes int64) (*HelmLogSink, error) {
+	if err := os.MkdirAll(filepath.Dir(path), 0755); err != nil {
+		return nil, err
+	}
+	file, err := os.OpenFile(path, os.O_RDWR|os.O_CREATE|os.O_APPEND, 0666)
+	if err != nil {
+		return nil, err
+	}
+	info, err := file.Stat()
+	if err != nil {
+		file.Close()
+		return nil, err
+	}
+
+	s := &HelmLogSink{
+		file:     file,
+		maxBytes: maxBytes,
+		queue:    make(chan helmLogEntry, helmLogQueueSize),
+		done:     make(chan struct{}),
+	}
+	go s.run(info.Size())
+	return s, nil
+}
+
+// File returns the underlying log file.
+func (s *HelmLogSink) File() *os.File {
+	return s.file
+}
+
+// Write queues a copy of p. It only blocks when the queue is full.
+func (s *HelmLogSink) Write(p []byte) (int, error) {
+	s.queue <- helmLogEntry{line: append([]byte(nil), p...)}
+	return len(p), nil
+}
+
+// Flush waits until all previously queued lines are written to the file and
+// returns the resulting file offset.
+func (s *HelmLogSink) Flush() int64 {
+	ack := make(chan int64, 1)
+	s.queue <- helmLogEntry{flush: ack}
+	return <-ack
+}
+
+// Close flushes the queue and closes the file.
+func (s *HelmLogSink) Close() error {
+	close(s.queue)
+	<-s.done
+	return s.file.Close()
+}
+
+func (s *HelmLogSink) run(offset int64) {
+	defer close(s.done)
+
+	w := bufio.NewWriterSize(s.file, 64*1024)
+	truncated := false
+	for entry := range s.queue {
+		if entry.flush != nil {
+			_ = w.Flush()
+			entry.flush <- offset
+			continue
+		}
+		if s.maxBytes > 0 && offset+int64(len(entry.line)) > s.maxBytes {
+			if !truncated {
+				n, _ := fmt.Fprintf(w, "... helm log truncated at %d bytes\n", s.maxBytes)
+				offset += int64(n)
+				truncated = true
+			}
+			continue
+		}
+		n, _ := w.Write(entry.line)
+		offset += int64(n)
+	}
+	_ = w.Flush()
+}
+
+// helmLog returns the Helm log sink of this process. When running in
+// parallel, every Ginkgo process writes to its own shard of
+// TestContext.HelmLogFile.
+func helmLog() (*HelmLogSink, error) {
+	helmLogMu.Lock()
+	defer helmLogMu.Unlock()
+
+	if helmLogSink != nil {
+		return helmLogSink, nil
+	}
+	path := TestContext.HelmLogFile
+	if suiteConfig, _ := ginkgo.GinkgoConfiguration(); suiteConfig.ParallelTotal > 1 {
+		path = fmt.Sprintf("%s-%d", path, suiteConfig.ParallelProcess)
+	}
+	sink, err := NewHelmLogSink(path, TestContext.HelmLogMaxBytes)
+	if err != nil {
+		return nil, err
+	}
+	helmLogSink = sink
+	return sink, nil
+}
+
+// CloseHelmLog writes out the queued lines of the Helm log sink of this
+// process and closes it. Lines logged after the last spec, e.g. by
+// SynchronizedInstall, are lost without it. It is meant to be registered
+// with ginkgo.AfterSuite, which runs on every process; SynchronizedInstall
+// registers it itself.
+func CloseHelmLog() error {
+	helmLogMu.Lock()
+	defer helmLogMu.Unlock()
+
+	if helmLogSink == nil {
+		return nil
+	}
+	err := helmLogSink.Close()
+	helmLogSink = nil
+	return err
+}
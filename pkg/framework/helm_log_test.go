@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+)
+
+// TestCloseHelmLog checks that lines queued after the last flush are written
+// when the sink is closed at the end of a suite.
+func TestCloseHelmLog(t *testing.T) {
+	saved := TestContext
+	defer func() { TestContext = saved }()
+	TestContext.HelmLogFile = filepath.Join(t.TempDir(), "helm.log")
+	if err := CloseHelmLog(); err != nil {
+		t.Fatal(err)
+	}
+
+	sink, err := helmLog()
+	if err != nil {
+		t.Fatal(err)
+	}
+	for i := 0; i < 3*helmLogQueueSize; i++ {
+		fmt.Fprintf(sink, "line %d\n", i)
+	}
+	if err := CloseHelmLog(); err != nil {
+		t.Fatal(err)
+	}
+	if err := CloseHelmLog(); err != nil {
+		t.Errorf("closing twice: %v", err)
+	}
+
+	data, err := os.ReadFile(TestContext.HelmLogFile)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if got := strings.Count(string(data), "\n"); got != 3*helmLogQueueSize {
+		t.Errorf("got %d lines, want %d", got, 3*helmLogQueueSize)
+	}
+}
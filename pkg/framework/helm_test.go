@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"fmt"
+	"net/http"
+	"net/http/httptest"
+	"os"
+	"path/filepath"
+	"sync/atomic"
+	"testing"
+
+	helm "github.com/mittwald/go-helm-client"
+	"helm.sh/helm/v3/pkg/cli"
+	"helm.sh/helm/v3/pkg/getter"
+	"helm.sh/helm/v3/pkg/helmpath"
+	"helm.sh/helm/v3/pkg/repo"
+	"k8s.io/client-go/rest"
+)
+
+const testIndex = `apiVersion: v1
+entries:
+  gpu-operator:
+  - name: gpu-operator
+    version: v24.3.0
+    urls:
+    - gpu-operator-v24.3.0.tgz
+`
+
+func TestChartCacheSharesIndexes(t *testing.T) {
+	var downloads atomic.Int32
+	server := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		downloads.Add(1)
+		w.Write([]byte(testIndex))
+	}))
+	defer server.Close()
+
+	dir := t.TempDir()
+	providers := getter.All(cli.New())
+	entry := repo.Entry{Name: "nvidia", URL: server.URL}
+
+	// Two processes sharing the cache directory, each with its own
+	// repository cache.
+	for process := 1; process <= 2; process++ {
+		cache := NewChartCache(dir, false)
+		cache.AddRepo(entry)
+		repoCache := filepath.Join(dir, fmt.Sprintf("repository-%d", process))
+		if err := cache.UpdateIndexes(repoCache, providers); err != nil {
+			t.Fatal(err)
+		}
+		if _, err := repo.LoadIndexFile(filepath.Join(repoCache, helmpath.CacheIndexFile(entry.Name))); err != nil {
+			t.Fatalf("process %d: %v", process, err)
+		}
+	}
+	if n := downloads.Load(); n != 1 {
+		t.Errorf("index downloaded %d times, want 1", n)
+	}
+
+	// Offline mode installs the cached index regardless of its age.
+	offline := NewChartCache(dir, true)
+	offline.AddRepo(entry)
+	repoCache := filepath.Join(dir, "repository-offline")
+	if err := offline.UpdateIndexes(repoCache, providers); err != nil {
+		t.Fatal(err)
+	}
+	if _, err := os.Stat(filepath.Join(repoCache, helmpath.CacheIndexFile(entry.Name))); err != nil {
+		t.Error(err)
+	}
+	if n := downloads.Load(); n != 1 {
+		t.Errorf("index downloaded %d times in offline mode, want 1", n)
+	}
+}
+
+func TestHelmClientFactoryNewClient(t *testing.T) {
+	saved := TestContext
+	defer func() { TestContext = saved }()
+	TestContext.HelmCacheDir = t.TempDir()
+	config := &rest.Config{Host: "https://cluster.example"}
+	factory := &HelmClientFactory{}
+
+	var clients []*helm.HelmClient
+	for _, namespace := range []string{"ns-a", "ns-b"} {
+		client, err := factory.NewClient(config, namespace, func(string, ...interface{}) {})
+		if err != nil {
+			t.Fatal(err)
+		}
+		hc := client.(*cachingHelmClient).Client.(*helm.HelmClient)
+		if got := hc.Settings.Namespace(); got != namespace {
+			t.Errorf("got settings namespace %q, want %q", got, namespace)
+		}
+		if _, ok := hc.ActionConfig.RESTClientGetter.(*restClientGetter); !ok {
+			t.Errorf("got REST client getter %T, want the shared one", hc.ActionConfig.RESTClientGetter)
+		}
+		if hc.ActionConfig.RegistryClient == nil {
+			t.Error("action config has no registry client")
+		}
+		clients = append(clients, hc)
+	}
+	if clients[0].ActionConfig == clients[1].ActionConfig || clients[0].Settings == clients[1].Settings {
+		t.Error("clients share their action config or settings")
+	}
+	if len(factory.bases) != 1 || len(factory.discovery) != 1 {
+		t.Errorf("got %d base clients and %d discovery clients, want 1 each", len(factory.bases), len(factory.discovery))
+	}
+}
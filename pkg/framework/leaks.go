@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"context"
+	"errors"
+	"fmt"
+	"path"
+	"sort"
+	"strconv"
+
+	"github.com/onsi/ginkgo/v2"
+	apierrors "k8s.io/apimachinery/pkg/api/errors"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	clientset "k8s.io/client-go/kubernetes"
+	"k8s.io/client-go/rest"
+
+	"github.com/NVIDIA/k8s-test-infra/pkg/kubernetes"
+)
+
+// LeakReportEntry is the name of the report entry holding the objects a
+// spec leaked.
+const LeakReportEntry = "leaked objects"
+
+// leakSnapshotPageSize bounds the size of every list response of a
+// snapshot; a snapshot costs one request per page and resource.
+const leakSnapshotPageSize = 500
+
+// LeakResource is a resource type included in cluster snapshots.
+type LeakResource struct {
+	Kind string
+	// APIPath is the path of the group version, e.g. "/apis/batch/v1".
+	APIPath    string
+	Resource   string
+	Namespaced bool
+}
+
+// DefaultLeakResources are the resource types tests commonly leave behind.
+// Pods are left out; they go away with their namespace and would make
+// snapshots of large clusters expensive.
+var DefaultLeakResources = []LeakResource{
+	{Kind: "Namespace", APIPath: "/api/v1", Resource: "namespaces"},
+	{Kind: "Node", APIPath: "/api/v1", Resource: "nodes"},
+	{Kind: "Job", APIPath: "/apis/batch/v1", Resource: "jobs", Namespaced: true},
+	{Kind: "NodeFeature", APIPath: "/apis/nfd.k8s-sigs.io/v1alpha1", Resource: "nodefeatures", Namespaced: true},
+	{Kind: "NodeFeatureRule", APIPath: "/apis/nfd.k8s-sigs.io/v1alpha1", Resource: "nodefeaturerules"},
+}
+
+// SnapshotObject is the metadata of one object of a snapshot.
+type SnapshotObject struct {
+	Kind            string            `json:"kind"`
+	Namespace       string            `json:"namespace,omitempty"`
+	Name            string            `json:"name"`
+	ResourceVersion string            `json:"resourceVersion"`
+	Labels          map[string]string `json:"labels,omitempty"`
+
+	resource *LeakResource
+}
+
+func (o SnapshotObject) key() string {
+	return o.Kind + "/" + o.Namespace + "/" + o.Name
+}
+
+// ClusterSnapshot holds the metadata of the objects of some resource types.
+type ClusterSnapshot struct {
+	resources []LeakResource
+	objects   map[string]SnapshotObject
+}
+
+// LeakReport lists the differences between two snapshots that hint at
+// objects a test failed to clean up.
+type LeakReport struct {
+	// Leaked are the objects created between the snapshots.
+	Leaked []SnapshotObject `json:"leaked,omitempty"`
+	// Relabeled are the objects whose labels changed between the
+	// snapshots, e.g. nodes that kept labels set by a test.
+	Relabeled []SnapshotObject `json:"relabeled,omitempty"`
+	// Unattributed are the objects that would be leaked or relabeled, but
+	// carry no RunID label while other Ginkgo processes run specs in
+	// parallel. They may come from a spec of another process, e.g.
+	// NodeFeatureRules or node labels, and are reported separately.
+	Unattributed []SnapshotObject `json:"unattributed,omitempty"`
+}
+
+// Empty reports whether no leaks were found.
+func (r LeakReport) Empty() bool {
+	return len(r.Leaked) == 0 && len(r.Relabeled) == 0 && len(r.Unattributed) == 0
+}
+
+// attribute moves the findings that can not be attributed to this process to
+// Unattributed: objects without the RunID label of this process, outside the
+// namespaces labelled with it.
+func (r *LeakReport) attribute(after *ClusterSnapshot) {
+	ours := func(obj SnapshotObject) bool {
+		if obj.Labels["e2e-run"] == string(RunID) {
+			return true
+		}
+		ns, ok := after.objects[SnapshotObject{Kind: "Namespace", Name: obj.Namespace}.key()]
+		return obj.Namespace != "" && ok && ns.Labels["e2e-run"] == string(RunID)
+	}
+	split := func(objects []SnapshotObject) []SnapshotObject {
+		var kept []SnapshotObject
+		for _, obj := range objects {
+			if ours(obj) {
+				kept = append(kept, obj)
+			} else {
+				r.Unattributed = append(r.Unattributed, obj)
+			}
+		}
+		return kept
+	}
+	r.Leaked = split(r.Leaked)
+	r.Relabeled = split(r.Relabeled)
+	sortSnapshotObjects(r.Unattributed)
+}
+
+// TakeSnapshot lists the metadata of all objects of the given resource types.
+// The server projects the lists into metadata-only tables, which are fetched
+// in pages of bounded size. Resource types the cluster does not serve are
+// skipped. Clientsets without a REST client, e.g. of simulated clusters, can
+// not be snapshotted and return kubernetes.ErrNoRESTClient.
+func TakeSnapshot(ctx context.Context, cs clientset.Interface, resources []LeakResource) (*ClusterSnapshot, error) {
+	rc, err := kubernetes.RESTClient(cs)
+	if err != nil {
+		return nil, err
+	}
+	snapshot := &ClusterSnapshot{
+		resources: append([]LeakResource(nil), resources...),
+		objects:   map[string]SnapshotObject{},
+	}
+	for i := range snapshot.resources {
+		if err := snapshot.add(ctx, rc, &snapshot.resources[i]); err != nil {
+			return nil, fmt.Errorf("error listing %s: %w", snapshot.resources[i].Resource, err)
+		}
+	}
+	return snapshot, nil
+}
+
+func (s *ClusterSnapshot) add(ctx context.Context, rc rest.Interface, resource *LeakResource) error {
+	continueToken := ""
+	for {
+		req := rc.Get().
+			AbsPath(resource.APIPath, resource.Resource).
+			Param("includeObject", string(metav1.IncludeMetadata)).
+			Param("limit", strconv.Itoa(leakSnapshotPageSize)).
+			SetHeader("Accept", kubernetes.TableMetadataAccept)
+		if continueToken != "" {
+			req = req.Param("continue", continueToken)
+		}
+		data, err := req.DoRaw(ctx)
+		if apierrors.IsNotFound(err) {
+			return nil
+		}
+		if err != nil {
+			return err
+		}
+
+		var objects []metav1.PartialObjectMetadata
+		objects, continueToken, err = kubernetes.DecodeMetadataTable(data)
+		if err != nil {
+			return err
+		}
+		for _, meta := range objects {
+			obj := SnapshotObject{
+				Kind:            resource.Kind,
+				Namespace:       meta.Namespace,
+				Name:            meta.Name,
+				ResourceVersion: meta.ResourceVersion,
+				Labels:          meta.Labels,
+				resource:        resource,
+			}
+			s.objects[obj.key()] = obj
+		}
+		if continueToken == "" {
+			return nil
+		}
+	}
+}
+
+// DiffSnapshots returns the objects that are new in after, and the objects
+// whose labels differ between before and after, in linear time. Objects
+// whose namespace is in ignoreNamespaces, and those namespaces themselves,
+// are left out, e.g. the namespaces of a spec that are still terminating.
+// So are objects labelled by other runs, e.g. parallel Ginkgo processes,
+// and the objects in their namespaces.
+func DiffSnapshots(before, after *ClusterSnapshot, ignoreNamespaces ...string) LeakReport {
+	ignored := make(map[string]bool, len(ignoreNamespaces))
+	for _, ns := range ignoreNamespaces {
+		ignored[ns] = true
+	}
+	for _, obj := range after.objects {
+		if obj.Kind == "Namespace" && otherRun(obj) {
+			ignored[obj.Name] = true
+		}
+	}
+
+	var report LeakReport
+	for key, obj := range after.objects {
+		if ignored[obj.Namespace] || obj.Kind == "Namespace" && ignored[obj.Name] || otherRun(obj) {
+			continue
+		}
+		old, ok := before.objects[key]
+		switch {
+		case !ok:
+			report.Leaked = append(report.Leaked, obj)
+		// Labels can only differ if the object changed.
+		case old.ResourceVersion != obj.ResourceVersion && !labelsEqual(old.Labels, obj.Labels):
+			report.Relabeled = append(report.Relabeled, obj)
+		}
+	}
+	sortSnapshotObjects(report.Leaked)
+	sortSnapshotObjects(report.Relabeled)
+	return report
+}
+
+// CollectLeaks deletes the leaked objects of report that are labelled with
+// the RunID of this process, and returns the deleted ones. Objects of other
+// runs and unlabelled objects are never touched.
+func CollectLeaks(ctx context.Context, cs clientset.Interface, report LeakReport) ([]SnapshotObject, error) {
+	rc, err := kubernetes.RESTClient(cs)
+	if err != nil {
+		return nil, err
+	}
+	var deleted []SnapshotObject
+	var errs error
+	for _, obj := range report.Leaked {
+		if obj.resource == nil || obj.Labels["e2e-run"] != string(RunID) {
+			continue
+		}
+		segments := []string{obj.resource.APIPath}
+		if obj.resource.Namespaced {
+			segments = append(segments, "namespaces", obj.Namespace)
+		}
+		segments = append(segments, obj.resource.Resource, obj.Name)
+		err := rc.Delete().AbsPath(path.Join(segments...)).Do(ctx).Error()
+		if err != nil && !apierrors.IsNotFound(err) {
+			errs = errors.Join(errs, fmt.Errorf("error deleting %s %s: %w", obj.Kind, obj.key(), err))
+			continue
+		}
+		deleted = append(deleted, obj)
+	}
+	return deleted, errs
+}
+
+// CheckLeaks takes a snapshot of the resource types of before, diffs it
+// against before and attaches the result to the current spec report. With
+// TestContext.CollectLeaks the leaked objects of this run are deleted. With
+// parallel Ginkgo processes, findings that can not be attributed to this
+// process are reported as Unattributed.
+// Suites check for leaks across all specs by taking the snapshot in
+// BeforeSuite and calling CheckLeaks in AfterSuite.
+func CheckLeaks(ctx context.Context, cs clientset.Interface, before *ClusterSnapshot, ignoreNamespaces ...string) (LeakReport, error) {
+	after, err := TakeSnapshot(ctx, cs, before.resources)
+	if err != nil {
+		return LeakReport{}, err
+	}
+	report := DiffSnapshots(before, after, ignoreNamespaces...)
+	if suiteConfig, _ := ginkgo.GinkgoConfiguration(); suiteConfig.ParallelTotal > 1 {
+		report.attribute(after)
+	}
+	if report.Empty() {
+		return report, nil
+	}
+	ginkgo.AddReportEntry(LeakReportEntry, report, ginkgo.ReportEntryVisibilityFailureOrVerbose)
+	if !TestContext.CollectLeaks {
+		return report, nil
+	}
+	deleted, err := CollectLeaks(ctx, cs, report)
+	for _, obj := range deleted {
+		ginkgo.By(fmt.Sprintf("[Cleanup]\tDeleted leaked %s %s", obj.Kind, obj.key()))
+	}
+	return report, err
+}
+
+func otherRun(obj SnapshotObject) bool {
+	run, ok := obj.Labels["e2e-run"]
+	return ok && run != string(RunID)
+}
+
+func labelsEqual(a, b map[string]string) bool {
+	if len(a) != len(b) {
+		return false
+	}
+	for k, v := range a {
+		if bv, ok := b[k]; !ok || bv != v {
+			return false
+		}
+	}
+	return true
+}
+
+func sortSnapshotObjects(objects []SnapshotObject) {
+	sort.Slice(objects, func(i, j int) bool { return objects[i].key() < objects[j].key() })
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"reflect"
+	"testing"
+)
+
+func testSnapshot(objects ...SnapshotObject) *ClusterSnapshot {
+	s := &ClusterSnapshot{objects: map[string]SnapshotObject{}}
+	for _, obj := range objects {
+		s.objects[obj.key()] = obj
+	}
+	return s
+}
+
+func snapshotKeys(objects []SnapshotObject) []string {
+	var keys []string
+	for _, obj := range objects {
+		keys = append(keys, obj.key())
+	}
+	return keys
+}
+
+func TestDiffSnapshotsAttribution(t *testing.T) {
+	ours := map[string]string{"e2e-run": string(RunID)}
+	before := testSnapshot(
+		SnapshotObject{Kind: "Node", Name: "gpu-0", ResourceVersion: "1", Labels: map[string]string{"gpu": "true"}},
+		SnapshotObject{Kind: "Node", Name: "gpu-1", ResourceVersion: "1", Labels: map[string]string{"gpu": "true"}},
+		SnapshotObject{Kind: "Node", Name: "gpu-2", ResourceVersion: "1", Labels: map[string]string{"gpu": "true"}},
+	)
+	after := testSnapshot(
+		// Relabeled, by any process.
+		SnapshotObject{Kind: "Node", Name: "gpu-0", ResourceVersion: "2", Labels: map[string]string{"gpu": "true", "test": "x"}},
+		// Changed, but with the same labels.
+		SnapshotObject{Kind: "Node", Name: "gpu-1", ResourceVersion: "2", Labels: map[string]string{"gpu": "true"}},
+		SnapshotObject{Kind: "Node", Name: "gpu-2", ResourceVersion: "1", Labels: map[string]string{"gpu": "true"}},
+		SnapshotObject{Kind: "Namespace", Name: "leaked", Labels: ours},
+		SnapshotObject{Kind: "Job", Namespace: "leaked", Name: "job"},
+		SnapshotObject{Kind: "Job", Namespace: "default", Name: "labelled", Labels: ours},
+		SnapshotObject{Kind: "NodeFeatureRule", Name: "rule"},
+	)
+
+	report := DiffSnapshots(before, after)
+	if got, want := snapshotKeys(report.Leaked), []string{"Job/default/labelled", "Job/leaked/job", "Namespace//leaked", "NodeFeatureRule//rule"}; !reflect.DeepEqual(got, want) {
+		t.Errorf("got leaked %v, want %v", got, want)
+	}
+	if got, want := snapshotKeys(report.Relabeled), []string{"Node//gpu-0"}; !reflect.DeepEqual(got, want) {
+		t.Errorf("got relabeled %v, want %v", got, want)
+	}
+
+	// With parallel processes, only objects labelled by this process or
+	// in its namespaces are attributed to it.
+	report.attribute(after)
+	if got, want := snapshotKeys(report.Leaked), []string{"Job/default/labelled", "Job/leaked/job", "Namespace//leaked"}; !reflect.DeepEqual(got, want) {
+		t.Errorf("got attributed leaks %v, want %v", got, want)
+	}
+	if len(report.Relabeled) != 0 {
+		t.Errorf("got attributed relabeled %v, want none", snapshotKeys(report.Relabeled))
+	}
+	if got, want := snapshotKeys(report.Unattributed), []string{"Node//gpu-0", "NodeFeatureRule//rule"}; !reflect.DeepEqual(got, want) {
+		t.Errorf("got unattributed %v, want %v", got, want)
+	}
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"encoding/json"
+	"fmt"
+	"math"
+	"os"
+	"sort"
+	"strings"
+	"time"
+
+	"github.com/onsi/ginkgo/v2"
+)
+
+// Phases of the framework setup and teardown that are timed for every spec.
+const (
+	PhaseClient            = "client"
+	PhaseNamespace         = "namespace"
+	PhaseHelmLog           = "helm-log"
+	PhaseHelmClient        = "helm-client"
+	PhaseHelmLogFlush      = "helm-log-flush"
+	PhaseNamespaceDeletion = "namespace-deletion"
+	// PhaseNamespaceVanish is the time WaitForNamespacesDeleted waited for
+	// deleted namespaces to disappear.
+	PhaseNamespaceVanish = "namespace-vanish"
+	// PhaseLeakSnapshot and PhaseLeakCheck are the snapshots taken with
+	// TestContext.DetectLeaks.
+	PhaseLeakSnapshot = "leak-snapshot"
+	PhaseLeakCheck    = "leak-check"
+)
+
+// PhaseReportEntryPrefix prefixes the names of the report entries holding
+// phase durations, e.g. "phase: client".
+const PhaseReportEntryPrefix = "phase: "
+
+// PhaseSummary aggregates the durations of one phase across a suite.
+type PhaseSummary struct {
+	Count      int     `json:"count"`
+	P50Seconds float64 `json:"p50Seconds"`
+	P95Seconds float64 `json:"p95Seconds"`
+	MaxSeconds float64 `json:"maxSeconds"`
+}
+
+// recordPhase attaches the time elapsed since start to the current spec report
+// and returns the current time, so that consecutive phases can be chained.
+func recordPhase(phase string, start time.Time) time.Time {
+	now := time.Now()
+	ginkgo.AddReportEntry(PhaseReportEntryPrefix+phase, now.Sub(start), ginkgo.ReportEntryVisibilityNever)
+	return now
+}
+
+// SummarizePhases computes the p50, p95 and max duration of every phase
+// recorded in the given suite report.
+func SummarizePhases(report ginkgo.Report) map[string]PhaseSummary {
+	durations := map[string][]time.Duration{}
+	for _, spec := range report.SpecReports {
+		for _, entry := range spec.ReportEntries {
+			phase, ok := strings.CutPrefix(entry.Name, PhaseReportEntryPrefix)
+			if !ok {
+				continue
+			}
+			// The raw value is lost when reports are merged across
+			// parallel processes, so always decode the JSON form.
+			var d time.Duration
+			if err := json.Unmarshal([]byte(entry.Value.AsJSON), &d); err != nil {
+				continue
+			}
+			durations[phase] = append(durations[phase], d)
+		}
+	}
+
+	summary := make(map[string]PhaseSummary, len(durations))
+	for phase, ds := range durations {
+		sort.Slice(ds, func(i, j int) bool { return ds[i] < ds[j] })
+		summary[phase] = PhaseSummary{
+			Count:      len(ds),
+			P50Seconds: percentile(ds, 0.50).Seconds(),
+			P95Seconds: percentile(ds, 0.95).Seconds(),
+			MaxSeconds: ds[len(ds)-1].Seconds(),
+		}
+	}
+	return summary
+}
+
+// ReportPhaseSummary writes the phase summary of the suite to
+// TestContext.PhaseSummaryFile. It is meant to be registered with
+// ginkgo.ReportAfterSuite.
+func ReportPhaseSummary(report ginkgo.Report) {
+	if TestContext.PhaseSummaryFile == "" {
+		return
+	}
+	data, err := json.MarshalIndent(SummarizePhases(report), "", "  ")
+	if err != nil {
+		ginkgo.Fail(fmt.Sprintf("error marshalling phase summary: %v", err))
+	}
+	if err := os.WriteFile(TestContext.PhaseSummaryFile, data, 0644); err != nil {
+		ginkgo.Fail(fmt.Sprintf("error writing phase summary: %v", err))
+	}
+}
+
+// percentile returns the nearest-rank percentile p of the sorted durations.
+func percentile(sorted []time.Duration, p float64) time.Duration {
+	idx := int(math.Ceil(p*float64(len(sorted)))) - 1
+	if idx < 0 {
+		idx = 0
+	}
+	return sorted[idx]
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"context"
+	"crypto/sha256"
+	"encoding/hex"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"log"
+	"sort"
+
+	helm "github.com/mittwald/go-helm-client"
+	"github.com/onsi/ginkgo/v2"
+	"github.com/onsi/gomega"
+	"helm.sh/helm/v3/pkg/action"
+	"helm.sh/helm/v3/pkg/chart"
+	"helm.sh/helm/v3/pkg/release"
+	"k8s.io/client-go/rest"
+)
+
+// SharedRelease is a Helm release installed once per suite and used by all
+// parallel Ginkgo processes.
+type SharedRelease struct {
+	ReleaseName string `json:"releaseName"`
+	Namespace   string `json:"namespace"`
+	// Fingerprint identifies the chart and values of the release.
+	Fingerprint string `json:"fingerprint"`
+	// Reused is true if a matching release already existed in the cluster.
+	Reused bool `json:"reused"`
+}
+
+// SharedReleases holds the releases set up by SynchronizedInstall, keyed by
+// release name. It is populated on every process before the first spec runs.
+type SharedReleases struct {
+	Releases map[string]SharedRelease `json:"releases"`
+}
+
+// Get returns the shared release with the given name.
+func (s *SharedReleases) Get(releaseName string) (SharedRelease, bool) {
+	r, ok := s.Releases[releaseName]
+	return r, ok
+}
+
+// SynchronizedInstall registers a ginkgo.SynchronizedBeforeSuite that
+// installs the given charts on the first process only and shares the release
+// names and namespaces with all processes. Releases whose chart and values
+// match what is already deployed are not reinstalled.
+//
+// Ginkgo allows a single SynchronizedBeforeSuite per suite; suites that need
+// their own should call InstallSharedRelease from it instead, and close the
+// Helm log with CloseHelmLog.
+func SynchronizedInstall(specs ...*helm.ChartSpec) *SharedReleases {
+	shared := &SharedReleases{}
+	ginkgo.SynchronizedBeforeSuite(func(ctx context.Context) []byte {
+		var config *rest.Config
+		if TestContext.Cluster == nil {
+			var err error
+			config, err = LoadConfig()
+			gomega.Expect(err).NotTo(gomega.HaveOccurred())
+		}
+
+		sink, err := helmLog()
+		gomega.Expect(err).NotTo(gomega.HaveOccurred())
+		// Failed expectations panic, flush on every way out.
+		defer sink.Flush()
+		logger := log.New(sink, "suite\t", log.Ldate|log.Ltime)
+
+		releases := SharedReleases{Releases: map[string]SharedRelease{}}
+		for _, spec := range specs {
+			client, err := newHelmClient(config, spec.Namespace, logger.Printf)
+			gomega.Expect(err).NotTo(gomega.HaveOccurred())
+
+			r, err := InstallSharedRelease(ctx, client, spec)
+			gomega.Expect(err).NotTo(gomega.HaveOccurred())
+			releases.Releases[r.ReleaseName] = r
+		}
+
+		data, err := json.Marshal(releases)
+		gomega.Expect(err).NotTo(gomega.HaveOccurred())
+		return data
+	}, func(data []byte) {
+		ginkgo.DeferCleanup(CloseHelmLog)
+		gomega.Expect(json.Unmarshal(data, shared)).To(gomega.Succeed())
+	})
+	return shared
+}
+
+// InstallSharedRelease installs or upgrades the release described by spec
+// unless a deployed release of the same chart with the same values exists.
+func InstallSharedRelease(ctx context.Context, client helm.Client, spec *helm.ChartSpec) (SharedRelease, error) {
+	values, err := spec.GetValuesMap(client.GetProviders())
+	if err != nil {
+		return SharedRelease{}, fmt.Errorf("error reading values of %s: %w", spec.ReleaseName, err)
+	}
+	chrt, _, err := client.GetChart(spec.ChartName, &action.ChartPathOptions{Version: spec.Version})
+	if err != nil {
+		return SharedRelease{}, fmt.Errorf("error loading chart of %s: %w", spec.ReleaseName, err)
+	}
+	fingerprint, err := releaseFingerprint(chrt, values)
+	if err != nil {
+		return SharedRelease{}, fmt.Errorf("error fingerprinting %s: %w", spec.ReleaseName, err)
+	}
+
+	if rel, err := client.GetRelease(spec.ReleaseName); err == nil && reusable(rel, fingerprint) {
+		return SharedRelease{
+			ReleaseName: rel.Name,
+			Namespace:   rel.Namespace,
+			Fingerprint: fingerprint,
+			Reused:      true,
+		}, nil
+	}
+
+	rel, err := client.InstallOrUpgradeChart(ctx, spec, nil)
+	if err != nil {
+		return SharedRelease{}, fmt.Errorf("error installing %s: %w", spec.ReleaseName, err)
+	}
+	return SharedRelease{
+		ReleaseName: rel.Name,
+		Namespace:   rel.Namespace,
+		Fingerprint: fingerprint,
+	}, nil
+}
+
+// reusable reports whether rel is deployed with the chart and values
+// identified by fingerprint. Release records without chart metadata are
+// never reused.
+func reusable(rel *release.Release, fingerprint string) bool {
+	if rel.Info == nil || rel.Info.Status != release.StatusDeployed {
+		return false
+	}
+	deployed, err := releaseFingerprint(rel.Chart, rel.Config)
+	return err == nil && deployed == fingerprint
+}
+
+// releaseFingerprint hashes the name, version and contents of a chart
+// together with the user supplied values. Releases do not record the
+// repository a chart came from, so charts are told apart by their templates,
+// files and schema instead: charts of the same name and version from
+// different repositories only match if they are the same chart. The default
+// values of the chart are left out, Helm rewrites them when processing
+// dependencies. encoding/json sorts map keys, so equal values hash equally.
+func releaseFingerprint(chrt *chart.Chart, values map[string]interface{}) (string, error) {
+	if chrt == nil || chrt.Metadata == nil {
+		return "", errors.New("chart has no metadata")
+	}
+	if values == nil {
+		values = map[string]interface{}{}
+	}
+	data, err := json.Marshal(values)
+	if err != nil {
+		return "", fmt.Errorf("error marshalling release values: %w", err)
+	}
+
+	h := sha256.New()
+	for _, part := range []string{chrt.Metadata.Name, chrt.Metadata.Version} {
+		h.Write([]byte(part + "\x00"))
+	}
+	for _, files := range [][]*chart.File{chrt.Templates, chrt.Files} {
+		sorted := append([]*chart.File(nil), files...)
+		sort.Slice(sorted, func(i, j int) bool { return sorted[i].Name < sorted[j].Name })
+		for _, f := range sorted {
+			fmt.Fprintf(h, "%s\x00%d\x00", f.Name, len(f.Data))
+			h.Write(f.Data)
+		}
+		h.Write([]byte{0})
+	}
+	h.Write(chrt.Schema)
+	h.Write([]byte{0})
+	h.Write(data)
+	return hex.EncodeToString(h.Sum(nil)), nil
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"context"
+	"os"
+	"path/filepath"
+	"testing"
+
+	helm "github.com/mittwald/go-helm-client"
+	"helm.sh/helm/v3/pkg/chart"
+	"helm.sh/helm/v3/pkg/release"
+)
+
+// writeChart writes a chart with a single ConfigMap template to dir.
+func writeChart(t *testing.T, dir, name, data string) string {
+	t.Helper()
+	if err := os.MkdirAll(filepath.Join(dir, "templates"), 0755); err != nil {
+		t.Fatal(err)
+	}
+	files := map[string]string{
+		"Chart.yaml":               "apiVersion: v2\nname: " + name + "\nversion: 0.1.0\n",
+		"templates/configmap.yaml": "apiVersion: v1\nkind: ConfigMap\nmetadata:\n  name: {{ .Release.Name }}\ndata:\n  key: " + data + "\n",
+	}
+	for file, content := range files {
+		if err := os.WriteFile(filepath.Join(dir, file), []byte(content), 0644); err != nil {
+			t.Fatal(err)
+		}
+	}
+	return dir
+}
+
+func TestInstallSharedRelease(t *testing.T) {
+	saved := TestContext
+	defer func() { TestContext = saved }()
+	TestContext.HelmCacheDir = t.TempDir()
+	cluster := NewSimulatedCluster()
+	defer cluster.Close()
+	client, err := cluster.HelmClient("shared", func(string, ...interface{}) {})
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	dir := t.TempDir()
+	app := writeChart(t, filepath.Join(dir, "repo-a", "app"), "app", "a")
+	// The same chart name and version, served by another repository.
+	otherRepo := writeChart(t, filepath.Join(dir, "repo-b", "app"), "app", "b")
+	// Another chart with the same version and templates.
+	otherName := writeChart(t, filepath.Join(dir, "repo-a", "other"), "other", "a")
+
+	steps := []struct {
+		name      string
+		chart     string
+		values    string
+		wantReuse bool
+	}{
+		{"first install", app, "replicas: 1", false},
+		{"same chart and values", app, "replicas: 1", true},
+		{"other values", app, "replicas: 2", false},
+		{"chart from another repository", otherRepo, "replicas: 2", false},
+		{"chart with another name", otherName, "replicas: 2", false},
+		{"unchanged again", otherName, "replicas: 2", true},
+	}
+	for _, step := range steps {
+		r, err := InstallSharedRelease(context.Background(), client, &helm.ChartSpec{
+			ReleaseName: "shared",
+			ChartName:   step.chart,
+			Version:     "0.1.0",
+			Namespace:   "shared",
+			ValuesYaml:  step.values,
+		})
+		if err != nil {
+			t.Fatalf("%s: %v", step.name, err)
+		}
+		if r.Reused != step.wantReuse {
+			t.Errorf("%s: got reused %v, want %v", step.name, r.Reused, step.wantReuse)
+		}
+	}
+}
+
+func TestReusableWithoutChartMetadata(t *testing.T) {
+	rel := &release.Release{
+		Info:  &release.Info{Status: release.StatusDeployed},
+		Chart: &chart.Chart{},
+	}
+	if reusable(rel, "") {
+		t.Error("release without chart metadata is reusable")
+	}
+	rel.Chart = nil
+	if reusable(rel, "") {
+		t.Error("release without chart is reusable")
+	}
+}
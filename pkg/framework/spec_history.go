@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"encoding/json"
+	"errors"
+	"fmt"
+	"hash/fnv"
+	"os"
+	"path/filepath"
+	"sort"
+	"sync"
+
+	"github.com/onsi/ginkgo/v2"
+	"github.com/onsi/ginkgo/v2/types"
+)
+
+// specHistoryWeight is the weight of the latest run in the recorded
+// duration of a spec; older runs decay exponentially.
+const specHistoryWeight = 0.5
+
+// SpecDuration is the recorded duration of one spec.
+type SpecDuration struct {
+	Seconds float64 `json:"seconds"`
+	Runs    int     `json:"runs"`
+}
+
+// SpecHistory maps spec names to their recorded durations.
+type SpecHistory map[string]SpecDuration
+
+// LoadSpecHistory reads the history file at path. A missing file yields an
+// empty history.
+func LoadSpecHistory(path string) (SpecHistory, error) {
+	data, err := os.ReadFile(path)
+	if errors.Is(err, os.ErrNotExist) {
+		return SpecHistory{}, nil
+	}
+	if err != nil {
+		return nil, err
+	}
+	history := SpecHistory{}
+	if err := json.Unmarshal(data, &history); err != nil {
+		return nil, fmt.Errorf("error decoding spec history %s: %w", path, err)
+	}
+	return history, nil
+}
+
+// Record adds the run time of the specs that ran in report.
+func (h SpecHistory) Record(report ginkgo.Report) {
+	for _, spec := range report.SpecReports {
+		if spec.LeafNodeType != types.NodeTypeIt || spec.State.Is(types.SpecStateSkipped|types.SpecStatePending) {
+			continue
+		}
+		name := specName(spec)
+		seconds := spec.RunTime.Seconds()
+		if d, ok := h[name]; ok {
+			seconds = specHistoryWeight*seconds + (1-specHistoryWeight)*d.Seconds
+		}
+		h[name] = SpecDuration{Seconds: seconds, Runs: h[name].Runs + 1}
+	}
+}
+
+// Save writes the history to path, replacing the file atomically.
+func (h SpecHistory) Save(path string) error {
+	data, err := json.MarshalIndent(h, "", "  ")
+	if err != nil {
+		return fmt.Errorf("error marshalling spec history: %w", err)
+	}
+	tmp, err := os.CreateTemp(filepath.Dir(path), filepath.Base(path)+".tmp-*")
+	if err != nil {
+		return err
+	}
+	defer os.Remove(tmp.Name())
+	if _, err := tmp.Write(data); err != nil {
+		tmp.Close()
+		return err
+	}
+	if err := tmp.Close(); err != nil {
+		return err
+	}
+	return os.Rename(tmp.Name(), path)
+}
+
+// RecordSpecHistory adds the spec durations of the suite to
+// TestContext.SpecHistoryFile. It is meant to be registered with
+// ginkgo.ReportAfterSuite.
+func RecordSpecHistory(report ginkgo.Report) {
+	if TestContext.SpecHistoryFile == "" {
+		return
+	}
+	history, err := LoadSpecHistory(TestContext.SpecHistoryFile)
+	if err != nil {
+		ginkgo.Fail(fmt.Sprintf("error reading spec history: %v", err))
+	}
+	history.Record(report)
+	if err := history.Save(TestContext.SpecHistoryFile); err != nil {
+		ginkgo.Fail(fmt.Sprintf("error writing spec history: %v", err))
+	}
+}
+
+// ShardPlan assigns specs to shards, e.g. separate CI jobs running the same
+// suite.
+type ShardPlan struct {
+	// Shards maps spec names to shard indexes.
+	Shards map[string]int `json:"shards"`
+	// Seconds is the expected run time of every shard.
+	Seconds []float64 `json:"seconds"`
+}
+
+// PlanShards distributes specs over the given number of shards with
+// longest-processing-time-first scheduling: specs are placed in order of
+// decreasing recorded duration, each on the shard with the least expected
+// run time so far. Specs without history are assumed to take the median
+// recorded duration.
+func PlanShards(specs []string, history SpecHistory, shards int) ShardPlan {
+	if shards < 1 {
+		shards = 1
+	}
+	var known []float64
+	for _, spec := range specs {
+		if d, ok := history[spec]; ok {
+			known = append(known, d.Seconds)
+		}
+	}
+	fallback := 1.0
+	if len(known) > 0 {
+		sort.Float64s(known)
+		fallback = known[len(known)/2]
+	}
+	estimate := func(spec string) float64 {
+		if d, ok := history[spec]; ok {
+			return d.Seconds
+		}
+		return fallback
+	}
+
+	ordered := append([]string(nil), specs...)
+	sort.SliceStable(ordered, func(i, j int) bool { return estimate(ordered[i]) > estimate(ordered[j]) })
+
+	plan := ShardPlan{Shards: make(map[string]int, len(specs)), Seconds: make([]float64, shards)}
+	for _, spec := range ordered {
+		// Shards are few, a linear scan for the least loaded one is enough.
+		least := 0
+		for i, seconds := range plan.Seconds {
+			if seconds < plan.Seconds[least] {
+				least = i
+			}
+		}
+		plan.Seconds[least] += estimate(spec)
+		plan.Shards[spec] = least
+	}
+	return plan
+}
+
+// Shard returns the shard of spec. Specs missing from the plan, e.g. new
+// ones, are spread by a hash of their name.
+func (p ShardPlan) Shard(spec string) int {
+	if shard, ok := p.Shards[spec]; ok {
+		return shard
+	}
+	h := fnv.New32a()
+	h.Write([]byte(spec))
+	return int(h.Sum32() % uint32(len(p.Seconds)))
+}
+
+// LoadShardPlan reads a plan written by SaveShardPlan.
+func LoadShardPlan(path string) (ShardPlan, error) {
+	var plan ShardPlan
+	data, err := os.ReadFile(path)
+	if err != nil {
+		return plan, err
+	}
+	if err := json.Unmarshal(data, &plan); err != nil {
+		return plan, fmt.Errorf("error decoding shard plan %s: %w", path, err)
+	}
+	if len(plan.Seconds) == 0 {
+		return plan, fmt.Errorf("shard plan %s has no shards", path)
+	}
+	return plan, nil
+}
+
+// SaveShardPlan writes plan to path.
+func SaveShardPlan(path string, plan ShardPlan) error {
+	data, err := json.MarshalIndent(plan, "", "  ")
+	if err != nil {
+		return fmt.Errorf("error marshalling shard plan: %w", err)
+	}
+	return os.WriteFile(path, data, 0644)
+}
+
+var (
+	shardPlanOnce sync.Once
+	shardPlan     ShardPlan
+	shardPlanErr  error
+)
+
+// skipOtherShards skips the current spec if TestContext.ShardPlanFile
+// assigns it to a shard other than TestContext.Shard.
+func skipOtherShards() {
+	if TestContext.ShardPlanFile == "" {
+		return
+	}
+	shardPlanOnce.Do(func() {
+		shardPlan, shardPlanErr = LoadShardPlan(TestContext.ShardPlanFile)
+		if shardPlanErr == nil && (TestContext.Shard < 0 || TestContext.Shard >= len(shardPlan.Seconds)) {
+			shardPlanErr = fmt.Errorf("shard %d is out of range, %s has %d shards", TestContext.Shard, TestContext.ShardPlanFile, len(shardPlan.Seconds))
+		}
+	})
+	if shardPlanErr != nil {
+		ginkgo.Fail(fmt.Sprintf("error reading shard plan: %v", shardPlanErr))
+	}
+	if shard := shardPlan.Shard(specName(ginkgo.CurrentSpecReport())); shard != TestContext.Shard {
+		ginkgo.Skip(fmt.Sprintf("spec is assigned to shard %d", shard))
+	}
+}
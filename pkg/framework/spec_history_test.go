@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"testing"
+)
+
+func TestPlanShards(t *testing.T) {
+	history := SpecHistory{
+		"a": {Seconds: 8},
+		"b": {Seconds: 5},
+		"c": {Seconds: 4},
+		"d": {Seconds: 3},
+	}
+	// "e" has no history and is assumed to take the median, 5s.
+	plan := PlanShards([]string{"a", "b", "c", "d", "e"}, history, 3)
+
+	want := map[string]int{"a": 0, "b": 1, "e": 2, "c": 1, "d": 2}
+	for spec, shard := range want {
+		if got := plan.Shard(spec); got != shard {
+			t.Errorf("spec %s planned on shard %d, want %d", spec, got, shard)
+		}
+	}
+	if got, want := plan.Seconds, []float64{8, 9, 8}; len(got) != 3 || got[0] != want[0] || got[1] != want[1] || got[2] != want[2] {
+		t.Errorf("got shard loads %v, want %v", got, want)
+	}
+}
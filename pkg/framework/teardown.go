@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"context"
+	"fmt"
+	"time"
+
+	helm "github.com/mittwald/go-helm-client"
+	"helm.sh/helm/v3/pkg/action"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+)
+
+// helmUninstallTimeout bounds the Helm uninstalls of a forced teardown.
+const helmUninstallTimeout = 2 * time.Minute
+
+// forceDeleteWorkloads uninstalls the Helm releases of namespace, then deletes
+// its jobs and finally its pods with a zero grace period, so that the
+// namespace controller has nothing left to terminate gracefully. The order
+// matters: controllers of releases that are still installed, and jobs, would
+// recreate deleted pods. Helm deletes the pods of a release gracefully;
+// deleting them again with a zero grace period cuts that short. Uninstalling
+// the releases also removes their cluster-scoped objects, which namespace
+// deletion would leave behind.
+func (f *Framework) forceDeleteWorkloads(ctx context.Context, namespace string) error {
+	if err := f.uninstallReleases(ctx, namespace); err != nil {
+		return err
+	}
+
+	zero := int64(0)
+	background := metav1.DeletePropagationBackground
+	options := metav1.DeleteOptions{GracePeriodSeconds: &zero, PropagationPolicy: &background}
+	if err := f.ClientSet.BatchV1().Jobs(namespace).DeleteCollection(ctx, options, metav1.ListOptions{}); err != nil {
+		return fmt.Errorf("error deleting jobs in %s: %w", namespace, err)
+	}
+	if err := f.ClientSet.CoreV1().Pods(namespace).DeleteCollection(ctx, options, metav1.ListOptions{}); err != nil {
+		return fmt.Errorf("error deleting pods in %s: %w", namespace, err)
+	}
+	return nil
+}
+
+// uninstallReleases uninstalls the Helm releases of namespace with the Helm
+// client of the spec if it is for that namespace. Helm does not take a
+// context, so waiting for an uninstall ends when ctx is done or
+// helmUninstallTimeout has passed.
+func (f *Framework) uninstallReleases(ctx context.Context, namespace string) error {
+	client := f.HelmClient
+	if client == nil || f.Namespace == nil || f.Namespace.Name != namespace {
+		debugLog := func(string, ...interface{}) {}
+		if f.HelmLogger != nil {
+			debugLog = f.HelmLogger.Printf
+		}
+		var err error
+		if client, err = newHelmClient(f.clientConfig, namespace, debugLog); err != nil {
+			return fmt.Errorf("error creating Helm client for %s: %w", namespace, err)
+		}
+	}
+
+	ctx, cancel := context.WithTimeout(ctx, helmUninstallTimeout)
+	defer cancel()
+	releases, err := client.ListReleasesByStateMask(action.ListAll)
+	if err != nil {
+		return fmt.Errorf("error listing Helm releases in %s: %w", namespace, err)
+	}
+	for _, rel := range releases {
+		timeout := helmUninstallTimeout
+		if deadline, ok := ctx.Deadline(); ok {
+			timeout = time.Until(deadline)
+		}
+		spec := &helm.ChartSpec{ReleaseName: rel.Name, Namespace: namespace, Timeout: timeout}
+		done := make(chan error, 1)
+		go func() { done <- client.UninstallRelease(spec) }()
+		select {
+		case err = <-done:
+		case <-ctx.Done():
+			err = ctx.Err()
+		}
+		if err != nil {
+			return fmt.Errorf("error uninstalling Helm release %s/%s: %w", namespace, rel.Name, err)
+		}
+	}
+	return nil
+}
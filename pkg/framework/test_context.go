@@ -20,6 +20,7 @@ import (
 	"context"
 	"flag"
 	"os"
+	"path/filepath"
 
 	corev1 "k8s.io/api/core/v1"
 	clientset "k8s.io/client-go/kubernetes"
@@ -35,8 +36,43 @@ type TestContextType struct {
 	KubeContext              string
 	DeleteNamespace          bool
 	DeleteNamespaceOnFailure bool
+	// FastNamespaceTeardown force-deletes the workloads of a namespace with
+	// a zero grace period before deleting it, and waits until it is gone.
+	FastNamespaceTeardown bool
+	// MeasureNamespaceVanish waits for deleted namespaces to disappear
+	// without force-deleting their workloads, to time PhaseNamespaceVanish.
+	MeasureNamespaceVanish bool
+	// DetectLeaks snapshots the metadata of DefaultLeakResources around
+	// every spec and reports the objects the spec left behind.
+	DetectLeaks bool
+	// CollectLeaks deletes the leaked objects labelled with the RunID.
+	CollectLeaks bool
 
 	HelmLogFile string
+	// HelmLogMaxBytes caps the size of each Helm log file; zero means unlimited.
+	HelmLogMaxBytes int64
+	// HelmCacheDir holds the chart cache shared by all Ginkgo processes
+	// and the per-process Helm repository configuration.
+	HelmCacheDir string
+	// HelmOffline serves charts from HelmCacheDir only and skips
+	// repository updates, for runners without network access.
+	HelmOffline bool
+
+	// PhaseSummaryFile is where ReportPhaseSummary writes the per-phase
+	// timing summary of the suite. Empty disables the summary.
+	PhaseSummaryFile string
+
+	// SpecHistoryFile is where RecordSpecHistory keeps the spec durations
+	// used to plan shards. Empty disables the history.
+	SpecHistoryFile string
+	// ShardPlanFile holds a ShardPlan; specs assigned to a shard other than
+	// Shard are skipped. Empty runs all specs.
+	ShardPlanFile string
+	Shard         int
+
+	// Cluster replaces the cluster reached through KubeConfig, e.g. with a
+	// SimulatedCluster, so that suites run without a real cluster.
+	Cluster Cluster
 
 	// CreateTestingNS is responsible for creating namespace used for executing e2e tests.
 	// It accepts namespace base name, which will be prepended with e2e prefix, kube client
@@ -51,7 +87,18 @@ var TestContext = TestContextType{}
 func RegisterClusterFlags(flags *flag.FlagSet) {
 	flags.BoolVar(&TestContext.DeleteNamespace, "delete-namespace", true, "If true tests will delete namespace after completion. It is only designed to make debugging easier, DO NOT turn it off by default.")
 	flags.BoolVar(&TestContext.DeleteNamespaceOnFailure, "delete-namespace-on-failure", true, "If true, framework will delete test namespace on failure. Used only during test debugging.")
+	flags.BoolVar(&TestContext.FastNamespaceTeardown, "fast-namespace-teardown", false, "If true, the pods, jobs and Helm releases of a test namespace are force-deleted with a zero grace period before the namespace is deleted.")
+	flags.BoolVar(&TestContext.MeasureNamespaceVanish, "measure-namespace-vanish", false, "If true, the time deleted test namespaces take to disappear is recorded even without --fast-namespace-teardown.")
+	flags.BoolVar(&TestContext.DetectLeaks, "detect-leaks", false, "If true, the namespaces, jobs, nodes and NFD objects a test leaves behind are attached to its report.")
+	flags.BoolVar(&TestContext.CollectLeaks, "collect-leaks", false, "If true, leaked objects labelled with the run ID of the test process are deleted. Requires --detect-leaks for per-test detection.")
 	flags.StringVar(&TestContext.KubeConfig, clientcmd.RecommendedConfigPathFlag, os.Getenv(clientcmd.RecommendedConfigPathEnvVar), "Path to kubeconfig containing embedded authinfo.")
 	flags.StringVar(&TestContext.KubeContext, clientcmd.FlagContext, "", "kubeconfig context to use/override. If unset, will use value from 'current-context'")
 	flags.StringVar(&TestContext.HelmLogFile, "helm-log-file", "e2e-helm", "Path to the file where helm logs will be written.")
+	flags.Int64Var(&TestContext.HelmLogMaxBytes, "helm-log-max-bytes", 256<<20, "Maximum size of a Helm log file, further lines are dropped. Zero disables the limit.")
+	flags.StringVar(&TestContext.HelmCacheDir, "helm-cache-dir", filepath.Join(os.TempDir(), "e2e-helm-cache"), "Directory holding the Helm chart cache shared by parallel test processes.")
+	flags.BoolVar(&TestContext.HelmOffline, "helm-offline", false, "If true, Helm charts are only served from the chart cache and repositories are not updated.")
+	flags.StringVar(&TestContext.SpecHistoryFile, "spec-history-file", "", "Path to the JSON file where spec durations are recorded for planning shards.")
+	flags.StringVar(&TestContext.ShardPlanFile, "shard-plan-file", "", "Path to a JSON shard plan. If set, only the specs assigned to --shard run.")
+	flags.IntVar(&TestContext.Shard, "shard", 0, "Index of the shard to run from --shard-plan-file.")
+	flags.StringVar(&TestContext.PhaseSummaryFile, "phase-summary-file", "", "Path to the JSON file where the framework setup and teardown timing summary will be written.")
 }
@@ -28,6 +28,7 @@ import (
 	corev1 "k8s.io/api/core/v1"
 	apierrors "k8s.io/apimachinery/pkg/api/errors"
 	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/runtime"
 	"k8s.io/apimachinery/pkg/util/uuid"
 	"k8s.io/apimachinery/pkg/util/wait"
 	clientset "k8s.io/client-go/kubernetes"
@@ -54,12 +55,7 @@ func RandomSuffix() string {
 func LoadConfig() (config *restclient.Config, err error) {
 	defer func() {
 		if err == nil && config != nil {
-			testDesc := ginkgo.CurrentSpecReport()
-			if len(testDesc.ContainerHierarchyTexts) > 0 {
-				testName := strings.Join(testDesc.ContainerHierarchyTexts, " ")
-				if len(testDesc.LeafNodeText) > 0 {
-					testName = testName + " " + testDesc.LeafNodeText
-				}
+			if testName := specName(ginkgo.CurrentSpecReport()); testName != "" {
 				config.UserAgent = fmt.Sprintf("%s -- %s", restclient.DefaultKubernetesUserAgent(), testName)
 			}
 		}
@@ -76,6 +72,28 @@ func LoadConfig() (config *restclient.Config, err error) {
 	return clientcmd.NewDefaultClientConfig(*c, &clientcmd.ConfigOverrides{}).ClientConfig()
 }
 
+// ProtobufConfig returns a copy of config that uses the protobuf wire format.
+// JSON stays in the accepted content types, so responses for resources without
+// a protobuf encoding (CRDs) are still decoded.
+func ProtobufConfig(config *restclient.Config) *restclient.Config {
+	ret := restclient.CopyConfig(config)
+	ret.ContentType = runtime.ContentTypeProtobuf
+	ret.AcceptContentTypes = runtime.ContentTypeProtobuf + "," + runtime.ContentTypeJSON
+	return ret
+}
+
+// specName returns the full text of the given spec, or "" outside of a container.
+func specName(testDesc ginkgo.SpecReport) string {
+	if len(testDesc.ContainerHierarchyTexts) == 0 {
+		return ""
+	}
+	testName := strings.Join(testDesc.ContainerHierarchyTexts, " ")
+	if len(testDesc.LeafNodeText) > 0 {
+		testName = testName + " " + testDesc.LeafNodeText
+	}
+	return testName
+}
+
 // restclientConfig returns a config holds the information needed to build connection to kubernetes clusters.
 func restclientConfig(kubeContext string) (*clientcmdapi.Config, error) {
 	if TestContext.KubeConfig == "" {
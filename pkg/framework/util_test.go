@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package framework
+
+import (
+	"fmt"
+	"testing"
+
+	corev1 "k8s.io/api/core/v1"
+	"k8s.io/apimachinery/pkg/api/resource"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/runtime"
+	"k8s.io/client-go/kubernetes/scheme"
+)
+
+func benchNodeList(n int) *corev1.NodeList {
+	list := &corev1.NodeList{TypeMeta: metav1.TypeMeta{Kind: "NodeList", APIVersion: "v1"}}
+	for i := 0; i < n; i++ {
+		list.Items = append(list.Items, corev1.Node{
+			ObjectMeta: metav1.ObjectMeta{
+				Name:            fmt.Sprintf("node-%d", i),
+				ResourceVersion: fmt.Sprint(1000 + i),
+				Labels: map[string]string{
+					"kubernetes.io/hostname":                         fmt.Sprintf("node-%d", i),
+					"nvidia.com/gpu.present":                         "true",
+					"nvidia.com/gpu.product":                         "NVIDIA-A100-SXM4-80GB",
+					"feature.node.kubernetes.io/pci-10de.present":    "true",
+					"feature.node.kubernetes.io/kernel-version.full": "5.15.0-1040",
+				},
+			},
+			Status: corev1.NodeStatus{
+				Capacity: corev1.ResourceList{
+					corev1.ResourceCPU:    resource.MustParse("96"),
+					corev1.ResourceMemory: resource.MustParse("1Ti"),
+					"nvidia.com/gpu":      resource.MustParse("8"),
+				},
+				Allocatable: corev1.ResourceList{
+					corev1.ResourceCPU:    resource.MustParse("95"),
+					corev1.ResourceMemory: resource.MustParse("1000Gi"),
+					"nvidia.com/gpu":      resource.MustParse("8"),
+				},
+				Conditions: []corev1.NodeCondition{
+					{Type: corev1.NodeReady, Status: corev1.ConditionTrue, Reason: "KubeletReady"},
+					{Type: corev1.NodeMemoryPressure, Status: corev1.ConditionFalse, Reason: "KubeletHasSufficientMemory"},
+				},
+				NodeInfo: corev1.NodeSystemInfo{KubeletVersion: "v1.30.0", ContainerRuntimeVersion: "containerd://1.7.0"},
+			},
+		})
+	}
+	return list
+}
+
+func benchPodList(n int) *corev1.PodList {
+	list := &corev1.PodList{TypeMeta: metav1.TypeMeta{Kind: "PodList", APIVersion: "v1"}}
+	for i := 0; i < n; i++ {
+		list.Items = append(list.Items, corev1.Pod{
+			ObjectMeta: metav1.ObjectMeta{
+				Name:            fmt.Sprintf("gpu-pod-%d", i),
+				Namespace:       "e2e-gpu",
+				ResourceVersion: fmt.Sprint(1000 + i),
+				Labels:          map[string]string{"app": "gpu-pod", "e2e-run": "bench"},
+			},
+			Spec: corev1.PodSpec{
+				NodeName: fmt.Sprintf("node-%d", i%100),
+				Containers: []corev1.Container{{
+					Name:  "cuda",
+					Image: "nvcr.io/nvidia/k8s/cuda-sample:vectoradd-cuda12.5.0",
+					Resources: corev1.ResourceRequirements{
+						Limits: corev1.ResourceList{"nvidia.com/gpu": resource.MustParse("1")},
+					},
+				}},
+			},
+			Status: corev1.PodStatus{
+				Phase:      corev1.PodRunning,
+				Conditions: []corev1.PodCondition{{Type: corev1.PodReady, Status: corev1.ConditionTrue}},
+			},
+		})
+	}
+	return list
+}
+
+// BenchmarkDecodeList compares decoding large lists from the JSON and the
+// protobuf wire format, as used by ClientSet with Options.Protobuf.
+func BenchmarkDecodeList(b *testing.B) {
+	lists := map[string]runtime.Object{
+		"NodeList": benchNodeList(5000),
+		"PodList":  benchPodList(5000),
+	}
+	for _, kind := range []string{"NodeList", "PodList"} {
+		for _, mediaType := range []string{runtime.ContentTypeJSON, runtime.ContentTypeProtobuf} {
+			info, ok := runtime.SerializerInfoForMediaType(scheme.Codecs.SupportedMediaTypes(), mediaType)
+			if !ok {
+				b.Fatalf("no serializer for %s", mediaType)
+			}
+			encoder := scheme.Codecs.EncoderForVersion(info.Serializer, corev1.SchemeGroupVersion)
+			data, err := runtime.Encode(encoder, lists[kind])
+			if err != nil {
+				b.Fatal(err)
+			}
+			decoder := scheme.Codecs.DecoderToVersion(info.Serializer, corev1.SchemeGroupVersion)
+
+			b.Run(kind+"/"+mediaType, func(b *testing.B) {
+				b.ReportAllocs()
+				b.SetBytes(int64(len(data)))
+				for i := 0; i < b.N; i++ {
+					if _, err := runtime.Decode(decoder, data); err != nil {
+						b.Fatal(err)
+					}
+				}
+			})
+		}
+	}
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package waiter
+
+import (
+	"fmt"
+
+	appsv1 "k8s.io/api/apps/v1"
+	batchv1 "k8s.io/api/batch/v1"
+	corev1 "k8s.io/api/core/v1"
+)
+
+// DeploymentAvailable is met once the latest generation of a Deployment is
+// rolled out and all of its replicas are available.
+func DeploymentAvailable(d *appsv1.Deployment) (bool, error) {
+	replicas := int32(1)
+	if d.Spec.Replicas != nil {
+		replicas = *d.Spec.Replicas
+	}
+	return d.Status.ObservedGeneration >= d.Generation &&
+		d.Status.UpdatedReplicas == replicas &&
+		d.Status.AvailableReplicas == replicas, nil
+}
+
+// DaemonSetRolledOut is met once the latest generation of a DaemonSet is
+// available on every node it is scheduled to.
+func DaemonSetRolledOut(ds *appsv1.DaemonSet) (bool, error) {
+	return ds.Status.ObservedGeneration >= ds.Generation &&
+		ds.Status.UpdatedNumberScheduled == ds.Status.DesiredNumberScheduled &&
+		ds.Status.NumberAvailable == ds.Status.DesiredNumberScheduled, nil
+}
+
+// DaemonSetRolledOutOn is met once a DaemonSet is rolled out and available on
+// at least the given number of nodes, e.g. the number of non-control-plane
+// nodes of the cluster.
+func DaemonSetRolledOutOn(nodes int) Condition[*appsv1.DaemonSet] {
+	return func(ds *appsv1.DaemonSet) (bool, error) {
+		done, err := DaemonSetRolledOut(ds)
+		return done && ds.Status.NumberAvailable >= int32(nodes), err
+	}
+}
+
+// JobSucceeded is met once a Job completed. It fails if the Job failed.
+func JobSucceeded(job *batchv1.Job) (bool, error) {
+	for _, c := range job.Status.Conditions {
+		if c.Status != corev1.ConditionTrue {
+			continue
+		}
+		switch c.Type {
+		case batchv1.JobComplete:
+			return true, nil
+		case batchv1.JobFailed:
+			return false, fmt.Errorf("job %s/%s failed: %s", job.Namespace, job.Name, c.Message)
+		}
+	}
+	return false, nil
+}
+
+// PodReady is met once a Pod reports the Ready condition. It fails if the Pod
+// terminated, as it can not become ready anymore.
+func PodReady(pod *corev1.Pod) (bool, error) {
+	switch pod.Status.Phase {
+	case corev1.PodFailed, corev1.PodSucceeded:
+		return false, fmt.Errorf("pod %s/%s terminated with phase %s", pod.Namespace, pod.Name, pod.Status.Phase)
+	}
+	for _, c := range pod.Status.Conditions {
+		if c.Type == corev1.PodReady {
+			return c.Status == corev1.ConditionTrue, nil
+		}
+	}
+	return false, nil
+}
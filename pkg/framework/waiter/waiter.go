@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Package waiter waits for Kubernetes objects to reach a condition by
+// watching them, instead of polling with a fixed interval. A wait returns on
+// the event that satisfies the condition, and interrupted watches resume from
+// the last observed resourceVersion.
+package waiter
+
+import (
+	"context"
+	"fmt"
+
+	appsv1 "k8s.io/api/apps/v1"
+	batchv1 "k8s.io/api/batch/v1"
+	corev1 "k8s.io/api/core/v1"
+	apierrors "k8s.io/apimachinery/pkg/api/errors"
+	"k8s.io/apimachinery/pkg/api/meta"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/fields"
+	"k8s.io/apimachinery/pkg/runtime"
+	"k8s.io/apimachinery/pkg/watch"
+	clientset "k8s.io/client-go/kubernetes"
+	"k8s.io/client-go/tools/cache"
+	watchtools "k8s.io/client-go/tools/watch"
+)
+
+// Condition reports whether obj reached the awaited state. An error aborts
+// the wait, e.g. when a Job failed and can never succeed.
+type Condition[T runtime.Object] func(obj T) (bool, error)
+
+// Deployment waits until the named Deployment satisfies cond.
+func Deployment(ctx context.Context, cs clientset.Interface, namespace, name string, cond Condition[*appsv1.Deployment]) (*appsv1.Deployment, error) {
+	c := cs.AppsV1().Deployments(namespace)
+	return forObject(ctx, name, listWatch(ctx, c.List, c.Watch), cond)
+}
+
+// DaemonSet waits until the named DaemonSet satisfies cond.
+func DaemonSet(ctx context.Context, cs clientset.Interface, namespace, name string, cond Condition[*appsv1.DaemonSet]) (*appsv1.DaemonSet, error) {
+	c := cs.AppsV1().DaemonSets(namespace)
+	return forObject(ctx, name, listWatch(ctx, c.List, c.Watch), cond)
+}
+
+// Job waits until the named Job satisfies cond.
+func Job(ctx context.Context, cs clientset.Interface, namespace, name string, cond Condition[*batchv1.Job]) (*batchv1.Job, error) {
+	c := cs.BatchV1().Jobs(namespace)
+	return forObject(ctx, name, listWatch(ctx, c.List, c.Watch), cond)
+}
+
+// Pod waits until the named Pod satisfies cond.
+func Pod(ctx context.Context, cs clientset.Interface, namespace, name string, cond Condition[*corev1.Pod]) (*corev1.Pod, error) {
+	c := cs.CoreV1().Pods(namespace)
+	return forObject(ctx, name, listWatch(ctx, c.List, c.Watch), cond)
+}
+
+// Deployments waits until every Deployment matching labelSelector satisfies cond.
+func Deployments(ctx context.Context, cs clientset.Interface, namespace, labelSelector string, cond Condition[*appsv1.Deployment]) error {
+	c := cs.AppsV1().Deployments(namespace)
+	return forAll(ctx, withLabelSelector(listWatch(ctx, c.List, c.Watch), labelSelector), &appsv1.Deployment{}, cond)
+}
+
+// DaemonSets waits until every DaemonSet matching labelSelector satisfies cond.
+func DaemonSets(ctx context.Context, cs clientset.Interface, namespace, labelSelector string, cond Condition[*appsv1.DaemonSet]) error {
+	c := cs.AppsV1().DaemonSets(namespace)
+	return forAll(ctx, withLabelSelector(listWatch(ctx, c.List, c.Watch), labelSelector), &appsv1.DaemonSet{}, cond)
+}
+
+// Pods waits until every Pod matching labelSelector satisfies cond.
+func Pods(ctx context.Context, cs clientset.Interface, namespace, labelSelector string, cond Condition[*corev1.Pod]) error {
+	c := cs.CoreV1().Pods(namespace)
+	return forAll(ctx, withLabelSelector(listWatch(ctx, c.List, c.Watch), labelSelector), &corev1.Pod{}, cond)
+}
+
+// forObject waits for the named object. It lists the object to learn the
+// current resourceVersion, and watches from there; an expired
+// resourceVersion restarts the wait with a fresh list.
+func forObject[T runtime.Object](ctx context.Context, name string, lw *cache.ListWatch, cond Condition[T]) (T, error) {
+	var zero T
+	lw = withFieldSelector(lw, fields.OneTermEqualSelector("metadata.name", name).String())
+	for {
+		list, err := lw.List(metav1.ListOptions{})
+		if err != nil {
+			return zero, err
+		}
+		items, err := meta.ExtractList(list)
+		if err != nil {
+			return zero, err
+		}
+		if len(items) > 0 {
+			obj, ok := items[0].(T)
+			if !ok {
+				return zero, fmt.Errorf("unexpected object type %T", items[0])
+			}
+			if done, err := cond(obj); err != nil || done {
+				return obj, err
+			}
+		}
+		listMeta, err := meta.ListAccessor(list)
+		if err != nil {
+			return zero, err
+		}
+
+		obj, restart, err := watchObject(ctx, listMeta.GetResourceVersion(), lw, cond)
+		if !restart {
+			return obj, err
+		}
+	}
+}
+
+// watchObject consumes a watch until cond is met. It reports restart=true
+// when the resourceVersion expired and the caller has to list again.
+func watchObject[T runtime.Object](ctx context.Context, resourceVersion string, lw *cache.ListWatch, cond Condition[T]) (T, bool, error) {
+	var zero T
+	var w watch.Interface
+	var err error
+	if resourceVersion == "" || resourceVersion == "0" {
+		// Fake clientsets do not track resource versions.
+		w, err = lw.Watch(metav1.ListOptions{})
+	} else {
+		w, err = watchtools.NewRetryWatcher(resourceVersion, lw)
+	}
+	if err != nil {
+		return zero, false, err
+	}
+	defer w.Stop()
+
+	for {
+		select {
+		case <-ctx.Done():
+			return zero, false, ctx.Err()
+		case event, ok := <-w.ResultChan():
+			if !ok {
+				return zero, false, fmt.Errorf("watch closed")
+			}
+			switch event.Type {
+			case watch.Error:
+				err := apierrors.FromObject(event.Object)
+				if apierrors.IsResourceExpired(err) || apierrors.IsGone(err) {
+					return zero, true, nil
+				}
+				return zero, false, err
+			case watch.Added, watch.Modified:
+				obj, ok := event.Object.(T)
+				if !ok {
+					return zero, false, fmt.Errorf("unexpected object type %T", event.Object)
+				}
+				if done, err := cond(obj); err != nil || done {
+					return obj, false, err
+				}
+			}
+		}
+	}
+}
+
+// forAll waits until every object of lw satisfies cond. An empty list
+// satisfies the wait immediately.
+func forAll[T runtime.Object](ctx context.Context, lw cache.ListerWatcher, objType T, cond Condition[T]) error {
+	pending := map[string]bool{}
+	check := func(obj interface{}) error {
+		key, err := cache.MetaNamespaceKeyFunc(obj)
+		if err != nil {
+			return err
+		}
+		typed, ok := obj.(T)
+		if !ok {
+			return fmt.Errorf("unexpected object type %T", obj)
+		}
+		done, err := cond(typed)
+		if err != nil {
+			return err
+		}
+		if done {
+			delete(pending, key)
+		} else {
+			pending[key] = true
+		}
+		return nil
+	}
+	precondition := func(store cache.Store) (bool, error) {
+		for _, obj := range store.List() {
+			if err := check(obj); err != nil {
+				return false, err
+			}
+		}
+		return len(pending) == 0, nil
+	}
+	condition := func(event watch.Event) (bool, error) {
+		if event.Type == watch.Deleted {
+			key, err := cache.DeletionHandlingMetaNamespaceKeyFunc(event.Object)
+			if err != nil {
+				return false, err
+			}
+			delete(pending, key)
+		} else if err := check(event.Object); err != nil {
+			return false, err
+		}
+		return len(pending) == 0, nil
+	}
+	_, err := watchtools.UntilWithSync(ctx, lw, objType, precondition, condition)
+	return err
+}
+
+func listWatch[L runtime.Object](ctx context.Context, list func(context.Context, metav1.ListOptions) (L, error), watchFn func(context.Context, metav1.ListOptions) (watch.Interface, error)) *cache.ListWatch {
+	return &cache.ListWatch{
+		ListFunc: func(options metav1.ListOptions) (runtime.Object, error) {
+			return list(ctx, options)
+		},
+		WatchFunc: func(options metav1.ListOptions) (watch.Interface, error) {
+			return watchFn(ctx, options)
+		},
+	}
+}
+
+func withFieldSelector(lw *cache.ListWatch, selector string) *cache.ListWatch {
+	return &cache.ListWatch{
+		ListFunc: func(options metav1.ListOptions) (runtime.Object, error) {
+			options.FieldSelector = selector
+			return lw.List(options)
+		},
+		WatchFunc: func(options metav1.ListOptions) (watch.Interface, error) {
+			options.FieldSelector = selector
+			return lw.Watch(options)
+		},
+	}
+}
+
+func withLabelSelector(lw *cache.ListWatch, selector string) *cache.ListWatch {
+	return &cache.ListWatch{
+		ListFunc: func(options metav1.ListOptions) (runtime.Object, error) {
+			options.LabelSelector = selector
+			return lw.List(options)
+		},
+		WatchFunc: func(options metav1.ListOptions) (watch.Interface, error) {
+			options.LabelSelector = selector
+			return lw.Watch(options)
+		},
+	}
+}
@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package waiter
+
+import (
+	"context"
+	"encoding/json"
+	"errors"
+	"testing"
+	"time"
+
+	appsv1 "k8s.io/api/apps/v1"
+	batchv1 "k8s.io/api/batch/v1"
+	corev1 "k8s.io/api/core/v1"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/types"
+	"k8s.io/apimachinery/pkg/util/wait"
+	clientset "k8s.io/client-go/kubernetes"
+	"k8s.io/utils/ptr"
+
+	"github.com/NVIDIA/k8s-test-infra/pkg/kubernetes/fakeapi"
+)
+
+const namespace = "default"
+
+func newServer(t *testing.T) (*fakeapi.Server, clientset.Interface) {
+	t.Helper()
+	server := fakeapi.NewServer()
+	t.Cleanup(server.Close)
+	cs, err := clientset.NewForConfig(server.Config())
+	if err != nil {
+		t.Fatal(err)
+	}
+	return server, cs
+}
+
+func newPod(name string, labels map[string]string, ready bool) *corev1.Pod {
+	pod := &corev1.Pod{
+		ObjectMeta: metav1.ObjectMeta{Name: name, Namespace: namespace, Labels: labels},
+		Spec:       corev1.PodSpec{Containers: []corev1.Container{{Name: "main", Image: "busybox"}}},
+		Status:     corev1.PodStatus{Phase: corev1.PodPending},
+	}
+	if ready {
+		setReady(pod)
+	}
+	return pod
+}
+
+func setReady(pod *corev1.Pod) {
+	pod.Status.Phase = corev1.PodRunning
+	pod.Status.Conditions = []corev1.PodCondition{{Type: corev1.PodReady, Status: corev1.ConditionTrue}}
+}
+
+// updatePod patches the status of a pod, without a GET that would count as
+// a list of the waiter.
+func updatePod(t *testing.T, cs clientset.Interface, name string, fn func(*corev1.Pod)) {
+	t.Helper()
+	var pod corev1.Pod
+	fn(&pod)
+	patch, err := json.Marshal(map[string]interface{}{"status": pod.Status})
+	if err != nil {
+		t.Fatal(err)
+	}
+	_, err = cs.CoreV1().Pods(namespace).Patch(context.Background(), name, types.MergePatchType, patch, metav1.PatchOptions{}, "status")
+	if err != nil {
+		t.Fatal(err)
+	}
+}
+
+// awaitWatch blocks until the server received n watch requests for resource.
+func awaitWatch(t *testing.T, server *fakeapi.Server, resource string, n int) {
+	t.Helper()
+	err := wait.PollUntilContextTimeout(context.Background(), 5*time.Millisecond, 10*time.Second, true, func(context.Context) (bool, error) {
+		return server.Count("WATCH "+resource) >= n, nil
+	})
+	if err != nil {
+		t.Fatalf("no watch on %s: %v", resource, err)
+	}
+}
+
+func TestConditions(t *testing.T) {
+	jobWith := func(typ batchv1.JobConditionType, status corev1.ConditionStatus) *batchv1.Job {
+		return &batchv1.Job{Status: batchv1.JobStatus{Conditions: []batchv1.JobCondition{{Type: typ, Status: status}}}}
+	}
+	rolledOut := &appsv1.DaemonSet{Status: appsv1.DaemonSetStatus{DesiredNumberScheduled: 2, UpdatedNumberScheduled: 2, NumberAvailable: 2}}
+
+	tests := []struct {
+		name    string
+		check   func() (bool, error)
+		want    bool
+		wantErr bool
+	}{
+		{"pod pending", func() (bool, error) { return PodReady(newPod("p", nil, false)) }, false, false},
+		{"pod ready", func() (bool, error) { return PodReady(newPod("p", nil, true)) }, true, false},
+		{"pod failed", func() (bool, error) {
+			pod := newPod("p", nil, false)
+			pod.Status.Phase = corev1.PodFailed
+			return PodReady(pod)
+		}, false, true},
+		{"job running", func() (bool, error) { return JobSucceeded(&batchv1.Job{}) }, false, false},
+		{"job complete", func() (bool, error) { return JobSucceeded(jobWith(batchv1.JobComplete, corev1.ConditionTrue)) }, true, false},
+		{"job failed", func() (bool, error) { return JobSucceeded(jobWith(batchv1.JobFailed, corev1.ConditionTrue)) }, false, true},
+		{"job failure pending", func() (bool, error) { return JobSucceeded(jobWith(batchv1.JobFailed, corev1.ConditionFalse)) }, false, false},
+		{"deployment available", func() (bool, error) {
+			return DeploymentAvailable(&appsv1.Deployment{
+				ObjectMeta: metav1.ObjectMeta{Generation: 2},
+				Spec:       appsv1.DeploymentSpec{Replicas: ptr.To[int32](3)},
+				Status:     appsv1.DeploymentStatus{ObservedGeneration: 2, UpdatedReplicas: 3, AvailableReplicas: 3},
+			})
+		}, true, false},
+		{"deployment generation not observed", func() (bool, error) {
+			return DeploymentAvailable(&appsv1.Deployment{
+				ObjectMeta: metav1.ObjectMeta{Generation: 2},
+				Status:     appsv1.DeploymentStatus{ObservedGeneration: 1, UpdatedReplicas: 1, AvailableReplicas: 1},
+			})
+		}, false, false},
+		{"daemonset rolled out", func() (bool, error) { return DaemonSetRolledOut(rolledOut) }, true, false},
+		{"daemonset on too few nodes", func() (bool, error) { return DaemonSetRolledOutOn(3)(rolledOut) }, false, false},
+		{"daemonset on enough nodes", func() (bool, error) { return DaemonSetRolledOutOn(2)(rolledOut) }, true, false},
+	}
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			got, err := tt.check()
+			if got != tt.want || (err != nil) != tt.wantErr {
+				t.Errorf("got %v, %v; want %v, error %v", got, err, tt.want, tt.wantErr)
+			}
+		})
+	}
+}
+
+// TestPod checks the single-object wait: conditions met by the initial list
+// or by watch events, aborting conditions, timeouts, and resuming after the
+// watch ended or its resourceVersion expired.
+func TestPod(t *testing.T) {
+	tests := []struct {
+		name    string
+		ready   bool
+		timeout time.Duration
+		// change runs once the wait watches the pod.
+		change  func(t *testing.T, server *fakeapi.Server, cs clientset.Interface)
+		wantErr error
+		// lists is the number of lists of the pod, 1 unless the wait restarted.
+		lists int
+		// watches is the minimum number of watches.
+		watches int
+	}{
+		{
+			name:  "ready when listed",
+			ready: true,
+			lists: 1,
+		},
+		{
+			name: "ready on watch event",
+			change: func(t *testing.T, _ *fakeapi.Server, cs clientset.Interface) {
+				updatePod(t, cs, "gpu-pod", setReady)
+			},
+			lists:   1,
+			watches: 1,
+		},
+		{
+			name: "terminated",
+			change: func(t *testing.T, _ *fakeapi.Server, cs clientset.Interface) {
+				updatePod(t, cs, "gpu-pod", func(pod *corev1.Pod) { pod.Status.Phase = corev1.PodFailed })
+			},
+			wantErr: errors.New("pod default/gpu-pod terminated with phase Failed"),
+			lists:   1,
+			watches: 1,
+		},
+		{
+			name:    "timeout",
+			timeout: 200 * time.Millisecond,
+			wantErr: context.DeadlineExceeded,
+			lists:   1,
+			watches: 1,
+		},
+		{
+			name: "watch ended",
+			change: func(t *testing.T, server *fakeapi.Server, cs clientset.Interface) {
+				server.StopWatches()
+				updatePod(t, cs, "gpu-pod", setReady)
+			},
+			lists:   1,
+			watches: 2,
+		},
+		{
+			name: "resourceVersion expired",
+			change: func(t *testing.T, server *fakeapi.Server, cs clientset.Interface) {
+				if err := server.Add("v1", "nodes", &corev1.Node{ObjectMeta: metav1.ObjectMeta{Name: "node"}}); err != nil {
+					t.Fatal(err)
+				}
+				server.Compact()
+				server.StopWatches()
+				updatePod(t, cs, "gpu-pod", setReady)
+			},
+			lists:   2,
+			watches: 2,
+		},
+	}
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			server, cs := newServer(t)
+			// A ready pod next to the awaited one must not satisfy the wait.
+			for _, pod := range []*corev1.Pod{newPod("another", nil, true), newPod("gpu-pod", nil, tt.ready)} {
+				if err := server.Add("v1", "pods", pod); err != nil {
+					t.Fatal(err)
+				}
+			}
+			timeout := tt.timeout
+			if timeout == 0 {
+				timeout = 30 * time.Second
+			}
+			ctx, cancel := context.WithTimeout(context.Background(), timeout)
+			defer cancel()
+
+			done := make(chan error, 1)
+			go func() {
+				pod, err := Pod(ctx, cs, namespace, "gpu-pod", PodReady)
+				if err == nil && pod.Name != "gpu-pod" {
+					err = errors.New("got pod " + pod.Name)
+				}
+				done <- err
+			}()
+			if tt.change != nil {
+				awaitWatch(t, server, "pods", 1)
+				tt.change(t, server, cs)
+			}
+			err := <-done
+
+			switch {
+			case tt.wantErr == nil && err != nil:
+				t.Fatalf("unexpected error: %v", err)
+			case tt.wantErr != nil && (err == nil || (!errors.Is(err, tt.wantErr) && err.Error() != tt.wantErr.Error())):
+				t.Fatalf("got error %v, want %v", err, tt.wantErr)
+			}
+			if got := server.Count("GET pods"); got != tt.lists {
+				t.Errorf("got %d lists, want %d", got, tt.lists)
+			}
+			if got := server.Count("WATCH pods"); got < tt.watches || (tt.watches == 0 && got != 0) {
+				t.Errorf("got %d watches, want at least %d", got, tt.watches)
+			}
+		})
+	}
+}
+
+func TestJob(t *testing.T) {
+	tests := []struct {
+		name      string
+		condition batchv1.JobConditionType
+		wantErr   bool
+	}{
+		{"complete", batchv1.JobComplete, false},
+		{"failed", batchv1.JobFailed, true},
+	}
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			server, cs := newServer(t)
+			ctx, cancel := context.WithTimeout(context.Background(), 30*time.Second)
+			defer cancel()
+			job := &batchv1.Job{ObjectMeta: metav1.ObjectMeta{Name: "gpu-job", Namespace: namespace}}
+			if err := server.Add("batch/v1", "jobs", job); err != nil {
+				t.Fatal(err)
+			}
+
+			done := make(chan error, 1)
+			go func() {
+				_, err := Job(ctx, cs, namespace, "gpu-job", JobSucceeded)
+				done <- err
+			}()
+			awaitWatch(t, server, "jobs", 1)
+			job.Status.Conditions = []batchv1.JobCondition{{Type: tt.condition, Status: corev1.ConditionTrue}}
+			if err := server.Add("batch/v1", "jobs", job); err != nil {
+				t.Fatal(err)
+			}
+			if err := <-done; (err != nil) != tt.wantErr {
+				t.Errorf("got error %v, want error %v", err, tt.wantErr)
+			}
+		})
+	}
+}
+
+// TestPods checks the wait for all pods matching a label selector.
+func TestPods(t *testing.T) {
+	selected := map[string]string{"app": "gpu"}
+	tests := []struct {
+		name   string
+		pods   []*corev1.Pod
+		change func(t *testing.T, cs clientset.Interface)
+	}{
+		{
+			name: "no pods",
+			pods: []*corev1.Pod{newPod("unselected", nil, false)},
+		},
+		{
+			name: "all ready when listed",
+			pods: []*corev1.Pod{newPod("a", selected, true), newPod("b", selected, true), newPod("unselected", nil, false)},
+		},
+		{
+			name: "ready on watch events",
+			pods: []*corev1.Pod{newPod("a", selected, false), newPod("b", selected, true), newPod("unselected", nil, false)},
+			change: func(t *testing.T, cs clientset.Interface) {
+				updatePod(t, cs, "a", setReady)
+			},
+		},
+		{
+			name: "pending pod deleted",
+			pods: []*corev1.Pod{newPod("a", selected, false), newPod("b", selected, true)},
+			change: func(t *testing.T, cs clientset.Interface) {
+				if err := cs.CoreV1().Pods(namespace).Delete(context.Background(), "a", metav1.DeleteOptions{}); err != nil {
+					t.Fatal(err)
+				}
+			},
+		},
+	}
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			server, cs := newServer(t)
+			for _, pod := range tt.pods {
+				if err := server.Add("v1", "pods", pod); err != nil {
+					t.Fatal(err)
+				}
+			}
+			ctx, cancel := context.WithTimeout(context.Background(), 30*time.Second)
+			defer cancel()
+
+			done := make(chan error, 1)
+			go func() { done <- Pods(ctx, cs, namespace, "app=gpu", PodReady) }()
+			if tt.change != nil {
+				awaitWatch(t, server, "pods", 1)
+				tt.change(t, cs)
+			}
+			if err := <-done; err != nil {
+				t.Fatal(err)
+			}
+		})
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"testing"
+
+	clientset "k8s.io/client-go/kubernetes"
+	nfdclient "sigs.k8s.io/node-feature-discovery/pkg/generated/clientset/versioned"
+
+	"github.com/NVIDIA/k8s-test-infra/pkg/kubernetes/fakeapi"
+)
+
+// fakeAPIServer adapts a fakeapi.Server to the tests and benchmarks of this
+// package.
+type fakeAPIServer struct {
+	*fakeapi.Server
+}
+
+func newFakeAPIServer(tb testing.TB) *fakeAPIServer {
+	s := fakeapi.NewServer()
+	tb.Cleanup(s.Close)
+	return &fakeAPIServer{Server: s}
+}
+
+func (s *fakeAPIServer) clientset(tb testing.TB) clientset.Interface {
+	cs, err := clientset.NewForConfig(s.Config())
+	if err != nil {
+		tb.Fatal(err)
+	}
+	return cs
+}
+
+func (s *fakeAPIServer) nfdClient(tb testing.TB) nfdclient.Interface {
+	cli, err := nfdclient.NewForConfig(s.Config())
+	if err != nil {
+		tb.Fatal(err)
+	}
+	return cli
+}
+
+// add seeds obj, see fakeapi.Server.Add.
+func (s *fakeAPIServer) add(groupVersion, resource string, obj interface{}) {
+	if err := s.Add(groupVersion, resource, obj); err != nil {
+		panic(err)
+	}
+}
+
+func (s *fakeAPIServer) count(request string) int {
+	return s.Count(request)
+}
+
+func (s *fakeAPIServer) resetCounts() {
+	s.ResetCounts()
+}
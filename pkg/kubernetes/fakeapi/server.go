@@ -0,0 +1,674 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Package fakeapi implements an in-memory Kubernetes API server for
+// simulated clusters, tests and benchmarks. It serves real clientsets over
+// HTTP; the client-go fake clientset is not vendored.
+package fakeapi
+
+import (
+	"encoding/json"
+	"fmt"
+	"io"
+	"net/http"
+	"net/http/httptest"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/fields"
+	"k8s.io/apimachinery/pkg/labels"
+	"k8s.io/apimachinery/pkg/watch"
+	"k8s.io/client-go/rest"
+)
+
+// kinds maps the resources served by Server to their kinds.
+var kinds = map[string]string{
+	"namespaces":       "Namespace",
+	"nodes":            "Node",
+	"pods":             "Pod",
+	"jobs":             "Job",
+	"deployments":      "Deployment",
+	"daemonsets":       "DaemonSet",
+	"nodefeatures":     "NodeFeature",
+	"nodefeaturerules": "NodeFeatureRule",
+}
+
+// Server is an in-memory API server for the resources in kinds. It supports
+// what the framework and the kubernetes helpers use: list with label
+// selectors, field selectors on metadata.name, metadata.namespace,
+// spec.nodeName and status.phase, pagination and Table projections, watch,
+// create, update, JSON merge patch with resourceVersion preconditions, delete
+// and deletecollection. Deleting a namespace deletes its objects right away.
+// There are no controllers, admission or validation. Objects are kept as
+// unstructured JSON.
+type Server struct {
+	*httptest.Server
+
+	mu        sync.Mutex
+	rv        int
+	compacted int
+	objects   map[string]map[string]map[string]interface{} // resource -> namespace/name -> object
+	events    []event
+	changed   chan struct{}
+	stop      chan struct{}
+	requests  map[string]int
+	faults    map[string][]int
+
+	bytes atomic.Int64
+}
+
+type event struct {
+	rv       int
+	resource string
+	typ      watch.EventType
+	object   map[string]interface{}
+}
+
+type request struct {
+	groupVersion, resource, namespace, name, subresource string
+}
+
+// NewServer starts a Server. Close it when done.
+func NewServer() *Server {
+	s := &Server{
+		objects:  map[string]map[string]map[string]interface{}{},
+		changed:  make(chan struct{}),
+		stop:     make(chan struct{}),
+		requests: map[string]int{},
+		faults:   map[string][]int{},
+	}
+	s.Server = httptest.NewServer(http.HandlerFunc(s.serve))
+	return s
+}
+
+// Config returns a client config for the server, without rate limits.
+func (s *Server) Config() *rest.Config {
+	return &rest.Config{Host: s.URL, QPS: -1}
+}
+
+// Add stores obj without going through HTTP, e.g. to seed large fixtures.
+func (s *Server) Add(groupVersion, resource string, obj interface{}) error {
+	if _, ok := kinds[resource]; !ok {
+		return fmt.Errorf("resource %s is not served", resource)
+	}
+	data, err := json.Marshal(obj)
+	if err != nil {
+		return err
+	}
+	var u map[string]interface{}
+	if err := json.Unmarshal(data, &u); err != nil {
+		return err
+	}
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	meta := metadata(u)
+	u["apiVersion"], u["kind"] = groupVersion, kinds[resource]
+	s.store(resource, watch.Added, objectKey(str(meta, "namespace"), str(meta, "name")), u)
+	return nil
+}
+
+// Count returns the number of requests with the given verb and resource,
+// e.g. "PATCH nodes/status". Watches are counted with the verb WATCH.
+func (s *Server) Count(request string) int {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	return s.requests[request]
+}
+
+// ResponseBytes returns the number of response body bytes written, including
+// watch events.
+func (s *Server) ResponseBytes() int64 {
+	return s.bytes.Load()
+}
+
+// ResetCounts resets the request and response byte counters.
+func (s *Server) ResetCounts() {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	s.requests = map[string]int{}
+	s.bytes.Store(0)
+}
+
+// Fail makes the next requests with the given verb and resource, as for
+// Count, fail with the given HTTP status codes, one code per request.
+func (s *Server) Fail(request string, codes ...int) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	s.faults[request] = append(s.faults[request], codes...)
+}
+
+// Compact drops the recorded events, as etcd compaction does. Watches from
+// an older resourceVersion fail with 410 Expired.
+func (s *Server) Compact() {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	s.events = nil
+	s.compacted = s.rv
+}
+
+// StopWatches ends all open watches, as an API server does on restart or
+// after a watch timeout. Clients have to watch again.
+func (s *Server) StopWatches() {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	close(s.stop)
+	s.stop = make(chan struct{})
+}
+
+func (s *Server) serve(w http.ResponseWriter, r *http.Request) {
+	req, ok := parsePath(r.URL.Path)
+	if !ok {
+		s.fail(w, http.StatusNotFound, metav1.StatusReasonNotFound, "unknown path "+r.URL.Path)
+		return
+	}
+	query := r.URL.Query()
+	verb := r.Method
+	if verb == http.MethodGet && query.Get("watch") == "true" {
+		verb = "WATCH"
+	}
+	resource := req.resource
+	if req.subresource != "" {
+		resource += "/" + req.subresource
+	}
+	s.mu.Lock()
+	s.requests[verb+" "+resource]++
+	code := 0
+	if codes := s.faults[verb+" "+resource]; len(codes) > 0 {
+		code, s.faults[verb+" "+resource] = codes[0], codes[1:]
+	}
+	s.mu.Unlock()
+	if code != 0 {
+		s.fail(w, code, faultReason(code), fmt.Sprintf("injected failure of %s %s", verb, resource))
+		return
+	}
+
+	labelSelector, err := labels.Parse(query.Get("labelSelector"))
+	if err != nil {
+		s.fail(w, http.StatusBadRequest, metav1.StatusReasonBadRequest, err.Error())
+		return
+	}
+	fieldSelector, err := fields.ParseSelector(query.Get("fieldSelector"))
+	if err != nil {
+		s.fail(w, http.StatusBadRequest, metav1.StatusReasonBadRequest, err.Error())
+		return
+	}
+	selector := selectors{labels: labelSelector, fields: fieldSelector}
+
+	switch {
+	case verb == "WATCH":
+		s.watch(w, r, req, selector)
+	case r.Method == http.MethodGet && req.name == "":
+		s.list(w, r, req, selector)
+	case r.Method == http.MethodGet:
+		s.get(w, req)
+	case r.Method == http.MethodPost && req.name == "":
+		s.create(w, r, req)
+	case r.Method == http.MethodPut:
+		s.update(w, r, req)
+	case r.Method == http.MethodPatch:
+		s.patch(w, r, req)
+	case r.Method == http.MethodDelete && req.name == "":
+		s.deleteCollection(w, req, selector)
+	case r.Method == http.MethodDelete:
+		s.delete(w, req)
+	default:
+		s.fail(w, http.StatusMethodNotAllowed, metav1.StatusReasonMethodNotAllowed, r.Method)
+	}
+}
+
+func parsePath(path string) (request, bool) {
+	var req request
+	parts := strings.Split(strings.Trim(path, "/"), "/")
+	switch {
+	case len(parts) >= 3 && parts[0] == "api":
+		req.groupVersion, parts = parts[1], parts[2:]
+	case len(parts) >= 4 && parts[0] == "apis":
+		req.groupVersion, parts = parts[1]+"/"+parts[2], parts[3:]
+	default:
+		return req, false
+	}
+	if len(parts) >= 3 && parts[0] == "namespaces" && parts[2] != "status" && parts[2] != "finalize" {
+		req.namespace, parts = parts[1], parts[2:]
+	}
+	req.resource = parts[0]
+	if len(parts) > 1 {
+		req.name = parts[1]
+	}
+	if len(parts) > 2 {
+		req.subresource = parts[2]
+	}
+	_, known := kinds[req.resource]
+	return req, known
+}
+
+func (s *Server) list(w http.ResponseWriter, r *http.Request, req request, selector selectors) {
+	s.mu.Lock()
+	var keys []string
+	for key, obj := range s.objects[req.resource] {
+		if matches(obj, req.namespace, selector) {
+			keys = append(keys, key)
+		}
+	}
+	sort.Strings(keys)
+	offset, _ := strconv.Atoi(r.URL.Query().Get("continue"))
+	end := len(keys)
+	if limit, _ := strconv.Atoi(r.URL.Query().Get("limit")); limit > 0 && offset+limit < end {
+		end = offset + limit
+	}
+	listMeta := map[string]interface{}{"resourceVersion": strconv.Itoa(s.rv)}
+	if end < len(keys) {
+		listMeta["continue"] = strconv.Itoa(end)
+	}
+	items := make([]map[string]interface{}, 0, end-offset)
+	for _, key := range keys[offset:end] {
+		items = append(items, s.objects[req.resource][key])
+	}
+	// Encode under the lock, stored objects are modified in place.
+	var data []byte
+	var err error
+	if strings.Contains(r.Header.Get("Accept"), "as=Table") {
+		rows := make([]map[string]interface{}, len(items))
+		for i, obj := range items {
+			rows[i] = map[string]interface{}{
+				"cells": []interface{}{str(metadata(obj), "name")},
+				"object": map[string]interface{}{
+					"kind":       "PartialObjectMetadata",
+					"apiVersion": "meta.k8s.io/v1",
+					"metadata":   obj["metadata"],
+				},
+			}
+		}
+		data, err = json.Marshal(map[string]interface{}{
+			"kind":              "Table",
+			"apiVersion":        "meta.k8s.io/v1",
+			"metadata":          listMeta,
+			"columnDefinitions": []interface{}{map[string]interface{}{"name": "Name", "type": "string"}},
+			"rows":              rows,
+		})
+	} else {
+		data, err = json.Marshal(map[string]interface{}{
+			"kind":       kinds[req.resource] + "List",
+			"apiVersion": req.groupVersion,
+			"metadata":   listMeta,
+			"items":      items,
+		})
+	}
+	s.mu.Unlock()
+	if err != nil {
+		s.fail(w, http.StatusInternalServerError, metav1.StatusReasonInternalError, err.Error())
+		return
+	}
+	s.write(w, http.StatusOK, data)
+}
+
+func (s *Server) get(w http.ResponseWriter, req request) {
+	s.mu.Lock()
+	obj, ok := s.objects[req.resource][objectKey(req.namespace, req.name)]
+	var data []byte
+	if ok {
+		data, _ = json.Marshal(obj)
+	}
+	s.mu.Unlock()
+	if !ok {
+		s.notFound(w, req)
+		return
+	}
+	s.write(w, http.StatusOK, data)
+}
+
+func (s *Server) create(w http.ResponseWriter, r *http.Request, req request) {
+	obj, ok := s.readObject(w, r)
+	if !ok {
+		return
+	}
+	s.mu.Lock()
+	meta := metadata(obj)
+	name := str(meta, "name")
+	if name == "" {
+		name = str(meta, "generateName") + strconv.Itoa(s.rv+1)
+		meta["name"] = name
+	}
+	if req.namespace != "" {
+		meta["namespace"] = req.namespace
+	}
+	key := objectKey(req.namespace, name)
+	if _, exists := s.objects[req.resource][key]; exists {
+		s.mu.Unlock()
+		s.fail(w, http.StatusConflict, metav1.StatusReasonAlreadyExists, fmt.Sprintf("%s %q already exists", req.resource, name))
+		return
+	}
+	meta["uid"] = fmt.Sprintf("uid-%d", s.rv+1)
+	meta["creationTimestamp"] = time.Now().UTC().Format(time.RFC3339)
+	obj["apiVersion"], obj["kind"] = req.groupVersion, kinds[req.resource]
+	s.store(req.resource, watch.Added, key, obj)
+	data, _ := json.Marshal(obj)
+	s.mu.Unlock()
+	s.write(w, http.StatusCreated, data)
+}
+
+func (s *Server) update(w http.ResponseWriter, r *http.Request, req request) {
+	obj, ok := s.readObject(w, r)
+	if !ok {
+		return
+	}
+	s.modify(w, req, str(metadata(obj), "resourceVersion"), func(current map[string]interface{}) map[string]interface{} {
+		if req.subresource == "status" {
+			current["status"] = obj["status"]
+			return current
+		}
+		obj["status"] = current["status"]
+		metadata(obj)["uid"] = metadata(current)["uid"]
+		metadata(obj)["creationTimestamp"] = metadata(current)["creationTimestamp"]
+		obj["apiVersion"], obj["kind"] = current["apiVersion"], current["kind"]
+		return obj
+	})
+}
+
+func (s *Server) patch(w http.ResponseWriter, r *http.Request, req request) {
+	patch, ok := s.readObject(w, r)
+	if !ok {
+		return
+	}
+	var precondition string
+	if meta, ok := patch["metadata"].(map[string]interface{}); ok {
+		precondition = str(meta, "resourceVersion")
+	}
+	s.modify(w, req, precondition, func(current map[string]interface{}) map[string]interface{} {
+		return mergePatch(current, patch)
+	})
+}
+
+// modify applies fn to the stored object if its resourceVersion matches
+// precondition, or unconditionally if precondition is empty.
+func (s *Server) modify(w http.ResponseWriter, req request, precondition string, fn func(map[string]interface{}) map[string]interface{}) {
+	s.mu.Lock()
+	key := objectKey(req.namespace, req.name)
+	current, ok := s.objects[req.resource][key]
+	if !ok {
+		s.mu.Unlock()
+		s.notFound(w, req)
+		return
+	}
+	if precondition != "" && precondition != str(metadata(current), "resourceVersion") {
+		s.mu.Unlock()
+		s.fail(w, http.StatusConflict, metav1.StatusReasonConflict,
+			fmt.Sprintf("Operation cannot be fulfilled on %s %q: the object has been modified", req.resource, req.name))
+		return
+	}
+	// Work on a copy, watchers may still be encoding the stored object.
+	var copied map[string]interface{}
+	data, _ := json.Marshal(current)
+	_ = json.Unmarshal(data, &copied)
+	updated := fn(copied)
+	s.store(req.resource, watch.Modified, key, updated)
+	data, _ = json.Marshal(updated)
+	s.mu.Unlock()
+	s.write(w, http.StatusOK, data)
+}
+
+func (s *Server) delete(w http.ResponseWriter, req request) {
+	s.mu.Lock()
+	key := objectKey(req.namespace, req.name)
+	obj, ok := s.objects[req.resource][key]
+	if ok {
+		s.remove(req.resource, key, obj)
+	}
+	if ok && req.resource == "namespaces" {
+		for resource, objects := range s.objects {
+			for key, obj := range objects {
+				if str(metadata(obj), "namespace") == req.name {
+					s.remove(resource, key, obj)
+				}
+			}
+		}
+	}
+	s.mu.Unlock()
+	if !ok {
+		s.notFound(w, req)
+		return
+	}
+	s.success(w)
+}
+
+func (s *Server) deleteCollection(w http.ResponseWriter, req request, selector selectors) {
+	s.mu.Lock()
+	for key, obj := range s.objects[req.resource] {
+		if matches(obj, req.namespace, selector) {
+			s.remove(req.resource, key, obj)
+		}
+	}
+	s.mu.Unlock()
+	s.success(w)
+}
+
+func (s *Server) watch(w http.ResponseWriter, r *http.Request, req request, selector selectors) {
+	flusher, ok := w.(http.Flusher)
+	if !ok {
+		s.fail(w, http.StatusInternalServerError, metav1.StatusReasonInternalError, "streaming unsupported")
+		return
+	}
+	since, _ := strconv.Atoi(r.URL.Query().Get("resourceVersion"))
+	timeout := time.Minute
+	if seconds, err := strconv.Atoi(r.URL.Query().Get("timeoutSeconds")); err == nil && seconds > 0 {
+		timeout = time.Duration(seconds) * time.Second
+	}
+	deadline := time.After(timeout)
+	s.mu.Lock()
+	stop := s.stop
+	compacted := s.compacted
+	s.mu.Unlock()
+
+	w.Header().Set("Content-Type", "application/json")
+	w.WriteHeader(http.StatusOK)
+	if since != 0 && since < compacted {
+		data, _ := json.Marshal(map[string]interface{}{"type": watch.Error, "object": metav1.Status{
+			TypeMeta: metav1.TypeMeta{Kind: "Status", APIVersion: "v1"},
+			Status:   metav1.StatusFailure,
+			Reason:   metav1.StatusReasonExpired,
+			Code:     http.StatusGone,
+			Message:  fmt.Sprintf("too old resource version: %d (%d)", since, compacted),
+		}})
+		n, _ := w.Write(append(data, '\n'))
+		s.bytes.Add(int64(n))
+		return
+	}
+	flusher.Flush()
+	for {
+		s.mu.Lock()
+		var out [][]byte
+		for _, e := range s.events {
+			if e.rv <= since || e.resource != req.resource || !matches(e.object, req.namespace, selector) {
+				continue
+			}
+			data, _ := json.Marshal(map[string]interface{}{"type": e.typ, "object": e.object})
+			out = append(out, append(data, '\n'))
+			since = e.rv
+		}
+		changed := s.changed
+		s.mu.Unlock()
+
+		for _, data := range out {
+			if _, err := w.Write(data); err != nil {
+				return
+			}
+			s.bytes.Add(int64(len(data)))
+		}
+		flusher.Flush()
+
+		select {
+		case <-changed:
+		case <-deadline:
+			return
+		case <-stop:
+			return
+		case <-r.Context().Done():
+			return
+		}
+	}
+}
+
+// store saves obj with a new resourceVersion and records the event. The
+// caller holds s.mu.
+func (s *Server) store(resource string, typ watch.EventType, key string, obj map[string]interface{}) {
+	s.rv++
+	metadata(obj)["resourceVersion"] = strconv.Itoa(s.rv)
+	if s.objects[resource] == nil {
+		s.objects[resource] = map[string]map[string]interface{}{}
+	}
+	s.objects[resource][key] = obj
+	s.emit(resource, typ, obj)
+}
+
+// remove deletes a stored object. The caller holds s.mu.
+func (s *Server) remove(resource, key string, obj map[string]interface{}) {
+	delete(s.objects[resource], key)
+	s.rv++
+	s.emit(resource, watch.Deleted, obj)
+}
+
+func (s *Server) emit(resource string, typ watch.EventType, obj map[string]interface{}) {
+	s.events = append(s.events, event{rv: s.rv, resource: resource, typ: typ, object: obj})
+	close(s.changed)
+	s.changed = make(chan struct{})
+}
+
+func (s *Server) readObject(w http.ResponseWriter, r *http.Request) (map[string]interface{}, bool) {
+	var obj map[string]interface{}
+	data, err := io.ReadAll(r.Body)
+	if err == nil {
+		err = json.Unmarshal(data, &obj)
+	}
+	if err != nil {
+		s.fail(w, http.StatusBadRequest, metav1.StatusReasonBadRequest, err.Error())
+		return nil, false
+	}
+	return obj, true
+}
+
+func (s *Server) write(w http.ResponseWriter, code int, data []byte) {
+	w.Header().Set("Content-Type", "application/json")
+	w.WriteHeader(code)
+	n, _ := w.Write(data)
+	s.bytes.Add(int64(n))
+}
+
+func (s *Server) success(w http.ResponseWriter) {
+	data, _ := json.Marshal(metav1.Status{
+		TypeMeta: metav1.TypeMeta{Kind: "Status", APIVersion: "v1"},
+		Status:   metav1.StatusSuccess,
+	})
+	s.write(w, http.StatusOK, data)
+}
+
+func (s *Server) notFound(w http.ResponseWriter, req request) {
+	s.fail(w, http.StatusNotFound, metav1.StatusReasonNotFound, fmt.Sprintf("%s %q not found", req.resource, req.name))
+}
+
+func (s *Server) fail(w http.ResponseWriter, code int, reason metav1.StatusReason, message string) {
+	data, _ := json.Marshal(metav1.Status{
+		TypeMeta: metav1.TypeMeta{Kind: "Status", APIVersion: "v1"},
+		Status:   metav1.StatusFailure,
+		Reason:   reason,
+		Code:     int32(code),
+		Message:  message,
+	})
+	s.write(w, code, data)
+}
+
+func faultReason(code int) metav1.StatusReason {
+	switch code {
+	case http.StatusConflict:
+		return metav1.StatusReasonConflict
+	case http.StatusNotFound:
+		return metav1.StatusReasonNotFound
+	case http.StatusTooManyRequests:
+		return metav1.StatusReasonTooManyRequests
+	case http.StatusServiceUnavailable:
+		return metav1.StatusReasonServiceUnavailable
+	}
+	return metav1.StatusReasonInternalError
+}
+
+// mergePatch applies a JSON merge patch (RFC 7386) to target.
+func mergePatch(target, patch map[string]interface{}) map[string]interface{} {
+	if target == nil {
+		target = map[string]interface{}{}
+	}
+	for key, value := range patch {
+		switch value := value.(type) {
+		case nil:
+			delete(target, key)
+		case map[string]interface{}:
+			sub, _ := target[key].(map[string]interface{})
+			target[key] = mergePatch(sub, value)
+		default:
+			target[key] = value
+		}
+	}
+	return target
+}
+
+func matches(obj map[string]interface{}, namespace string, selector selectors) bool {
+	meta := metadata(obj)
+	if namespace != "" && str(meta, "namespace") != namespace {
+		return false
+	}
+	set := labels.Set{}
+	if l, ok := meta["labels"].(map[string]interface{}); ok {
+		for k, v := range l {
+			set[k], _ = v.(string)
+		}
+	}
+	if !selector.labels.Matches(set) {
+		return false
+	}
+	spec, _ := obj["spec"].(map[string]interface{})
+	status, _ := obj["status"].(map[string]interface{})
+	return selector.fields.Matches(fields.Set{
+		"metadata.name":      str(meta, "name"),
+		"metadata.namespace": str(meta, "namespace"),
+		"spec.nodeName":      str(spec, "nodeName"),
+		"status.phase":       str(status, "phase"),
+	})
+}
+
+type selectors struct {
+	labels labels.Selector
+	fields fields.Selector
+}
+
+func metadata(obj map[string]interface{}) map[string]interface{} {
+	meta, ok := obj["metadata"].(map[string]interface{})
+	if !ok {
+		meta = map[string]interface{}{}
+		obj["metadata"] = meta
+	}
+	return meta
+}
+
+func str(m map[string]interface{}, key string) string {
+	s, _ := m[key].(string)
+	return s
+}
+
+func objectKey(namespace, name string) string {
+	return namespace + "/" + name
+}
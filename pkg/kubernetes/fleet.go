@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"fmt"
+	"runtime"
+	"strconv"
+	"time"
+
+	"golang.org/x/sync/errgroup"
+	corev1 "k8s.io/api/core/v1"
+	"k8s.io/apimachinery/pkg/api/resource"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	k8sruntime "k8s.io/apimachinery/pkg/runtime"
+	"k8s.io/apimachinery/pkg/util/wait"
+	"k8s.io/apimachinery/pkg/watch"
+	clientset "k8s.io/client-go/kubernetes"
+	"k8s.io/client-go/tools/cache"
+	nfdv1alpha1 "sigs.k8s.io/node-feature-discovery/pkg/apis/nfd/v1alpha1"
+	nfdclient "sigs.k8s.io/node-feature-discovery/pkg/generated/clientset/versioned"
+)
+
+// FakeNodeAnnotation marks the nodes created by CreateGPUFleet, like kwok
+// does for its nodes.
+const FakeNodeAnnotation = "kwok.x-k8s.io/node"
+
+// controlPlaneLabel is the label and taint key of control-plane nodes.
+const controlPlaneLabel = "node-role.kubernetes.io/control-plane"
+
+// GPUFleet describes a fleet of fake nodes for scale testing helpers without
+// a real cluster.
+type GPUFleet struct {
+	// NamePrefix prefixes the node names, which are suffixed with their
+	// index. Defaults to "fake-gpu-node".
+	NamePrefix string
+	// Nodes is the number of GPU worker nodes.
+	Nodes int
+	// ControlPlaneNodes is the number of tainted control-plane nodes, which
+	// have no GPUs.
+	ControlPlaneNodes int
+	// GPUsPerNode is the nvidia.com/gpu capacity of every worker node.
+	// Defaults to 8.
+	GPUsPerNode int
+	// NFD adds NFD feature labels and annotations to the worker nodes and,
+	// if CreateGPUFleet is given an NFD client, a NodeFeature object per
+	// worker node in NFDNamespace.
+	NFD          bool
+	NFDNamespace string
+	// Parallelism bounds the number of create requests in flight. Zero
+	// uses GOMAXPROCS.
+	Parallelism int
+}
+
+func (f *GPUFleet) defaults() {
+	if f.NamePrefix == "" {
+		f.NamePrefix = "fake-gpu-node"
+	}
+	if f.GPUsPerNode == 0 {
+		f.GPUsPerNode = 8
+	}
+	if f.Parallelism <= 0 {
+		f.Parallelism = runtime.GOMAXPROCS(0)
+	}
+}
+
+// WorkerName returns the name of the i-th worker node.
+func (f GPUFleet) WorkerName(i int) string {
+	f.defaults()
+	return f.NamePrefix + "-" + strconv.Itoa(i)
+}
+
+// NewNode returns the i-th node of the fleet. Indexes below ControlPlaneNodes
+// are control-plane nodes, the following ones are GPU worker nodes.
+func (f GPUFleet) NewNode(i int) *corev1.Node {
+	f.defaults()
+	var name string
+	controlPlane := i < f.ControlPlaneNodes
+	if controlPlane {
+		name = f.NamePrefix + "-control-plane-" + strconv.Itoa(i)
+	} else {
+		name = f.WorkerName(i - f.ControlPlaneNodes)
+	}
+
+	resources := corev1.ResourceList{
+		corev1.ResourceCPU:    resource.MustParse("32"),
+		corev1.ResourceMemory: resource.MustParse("256Gi"),
+		corev1.ResourcePods:   resource.MustParse("110"),
+	}
+	node := &corev1.Node{
+		ObjectMeta: metav1.ObjectMeta{
+			Name: name,
+			Labels: map[string]string{
+				"kubernetes.io/hostname": name,
+				"kubernetes.io/os":       "linux",
+				"type":                   "kwok",
+			},
+			Annotations: map[string]string{
+				FakeNodeAnnotation: "fake",
+			},
+		},
+		Status: corev1.NodeStatus{
+			Conditions: []corev1.NodeCondition{{
+				Type:   corev1.NodeReady,
+				Status: corev1.ConditionTrue,
+				Reason: "KubeletReady",
+			}},
+		},
+	}
+
+	if controlPlane {
+		node.Labels[controlPlaneLabel] = ""
+		node.Spec.Taints = []corev1.Taint{{
+			Key:    controlPlaneLabel,
+			Effect: corev1.TaintEffectNoSchedule,
+		}}
+	} else {
+		resources[GPUResource] = *resource.NewQuantity(int64(f.GPUsPerNode), resource.DecimalSI)
+		node.Labels["nvidia.com/gpu.present"] = "true"
+		if f.NFD {
+			for key, value := range fleetNFDLabels() {
+				node.Labels[key] = value
+			}
+			node.Annotations[nfdv1alpha1.FeatureLabelsAnnotation] = "nvidia.com/gpu.present,pci-10de.present"
+			node.Annotations[nfdv1alpha1.AnnotationNs+"/worker.version"] = "fake"
+		}
+	}
+	node.Status.Capacity = resources
+	node.Status.Allocatable = resources.DeepCopy()
+	return node
+}
+
+// NewNodeFeature returns the NodeFeature object of the i-th worker node.
+func (f GPUFleet) NewNodeFeature(i int) *nfdv1alpha1.NodeFeature {
+	f.defaults()
+	name := f.WorkerName(i)
+	return &nfdv1alpha1.NodeFeature{
+		ObjectMeta: metav1.ObjectMeta{
+			Name:      name,
+			Namespace: f.NFDNamespace,
+			Labels: map[string]string{
+				nfdv1alpha1.NodeFeatureObjNodeNameLabel: name,
+			},
+		},
+		Spec: nfdv1alpha1.NodeFeatureSpec{
+			Labels: fleetNFDLabels(),
+		},
+	}
+}
+
+func fleetNFDLabels() map[string]string {
+	return map[string]string{
+		nfdv1alpha1.FeatureLabelNs + "/pci-10de.present":             "true",
+		nfdv1alpha1.FeatureLabelNs + "/kernel-version.major":         "6",
+		nfdv1alpha1.FeatureLabelNs + "/cpu-cpuid.AVX512F":            "true",
+		nfdv1alpha1.FeatureLabelNs + "/system-os_release.ID":         "ubuntu",
+		nfdv1alpha1.FeatureLabelNs + "/system-os_release.VERSION_ID": "22.04",
+	}
+}
+
+// CreateGPUFleet creates the nodes of the fleet, and their NodeFeature
+// objects if fleet.NFD is set and nfd is not nil. It works against any
+// clientset, including fake ones, and returns the names of the worker nodes.
+func CreateGPUFleet(ctx context.Context, cs clientset.Interface, nfd nfdclient.Interface, fleet GPUFleet) ([]string, error) {
+	fleet.defaults()
+	total := fleet.ControlPlaneNodes + fleet.Nodes
+
+	g, ctx := errgroup.WithContext(ctx)
+	g.SetLimit(fleet.Parallelism)
+	for i := 0; i < total; i++ {
+		node := fleet.NewNode(i)
+		g.Go(func() error {
+			created, err := cs.CoreV1().Nodes().Create(ctx, node, metav1.CreateOptions{})
+			if err != nil {
+				return fmt.Errorf("error creating node %s: %w", node.Name, err)
+			}
+			// Real API servers drop the status on create.
+			created.Status = node.Status
+			if _, err := cs.CoreV1().Nodes().UpdateStatus(ctx, created, metav1.UpdateOptions{}); err != nil {
+				return fmt.Errorf("error updating status of node %s: %w", node.Name, err)
+			}
+			return nil
+		})
+	}
+	if fleet.NFD && nfd != nil {
+		for i := 0; i < fleet.Nodes; i++ {
+			nf := fleet.NewNodeFeature(i)
+			g.Go(func() error {
+				if _, err := nfd.NfdV1alpha1().NodeFeatures(nf.Namespace).Create(ctx, nf, metav1.CreateOptions{}); err != nil {
+					return fmt.Errorf("error creating NodeFeature %s: %w", nf.Name, err)
+				}
+				return nil
+			})
+		}
+	}
+	if err := g.Wait(); err != nil {
+		return nil, err
+	}
+
+	names := make([]string, fleet.Nodes)
+	for i := range names {
+		names[i] = fleet.WorkerName(i)
+	}
+	return names, nil
+}
+
+// podSimulatorBackoff paces the retries of pod status updates after
+// conflicts or throttling.
+var podSimulatorBackoff = wait.Backoff{
+	Duration: 10 * time.Millisecond,
+	Factor:   2,
+	Jitter:   0.5,
+	Steps:    10,
+	Cap:      time.Second,
+}
+
+// PodSimulator stands in for the kubelets of fake nodes: it marks pods bound
+// to them as running, and pods that do not restart as succeeded after
+// RunDuration. Pods are not scheduled, bind them with a nodeName, e.g. with a
+// Placement.
+type PodSimulator struct {
+	cs    clientset.Interface
+	nodes map[string]bool
+	// RunDuration is how long a pod of a Job runs before it succeeds. Zero
+	// keeps pods running.
+	RunDuration time.Duration
+}
+
+// NewPodSimulator returns a simulator for the pods bound to the named nodes.
+func NewPodSimulator(cs clientset.Interface, nodeNames []string, runDuration time.Duration) *PodSimulator {
+	nodes := make(map[string]bool, len(nodeNames))
+	for _, name := range nodeNames {
+		nodes[name] = true
+	}
+	return &PodSimulator{cs: cs, nodes: nodes, RunDuration: runDuration}
+}
+
+// Run simulates the pods until ctx is done.
+func (s *PodSimulator) Run(ctx context.Context) error {
+	pods := s.cs.CoreV1().Pods(metav1.NamespaceAll)
+	informer := cache.NewSharedIndexInformer(&cache.ListWatch{
+		ListFunc: func(options metav1.ListOptions) (k8sruntime.Object, error) {
+			return pods.List(ctx, options)
+		},
+		WatchFunc: func(options metav1.ListOptions) (watch.Interface, error) {
+			return pods.Watch(ctx, options)
+		},
+	}, &corev1.Pod{}, 0, cache.Indexers{})
+	handle := func(obj interface{}) {
+		if pod, ok := obj.(*corev1.Pod); ok {
+			s.start(ctx, pod)
+		}
+	}
+	if _, err := informer.AddEventHandler(cache.ResourceEventHandlerFuncs{
+		AddFunc:    handle,
+		UpdateFunc: func(_, obj interface{}) { handle(obj) },
+	}); err != nil {
+		return err
+	}
+	informer.Run(ctx.Done())
+	return ctx.Err()
+}
+
+// start moves a pending pod bound to a fake node to running. A pending pod
+// gets no further events that would retry a failed update, so conflicting
+// and throttled updates are retried with a fresh copy of the pod.
+func (s *PodSimulator) start(ctx context.Context, pod *corev1.Pod) {
+	if !s.pending(pod) {
+		return
+	}
+	namespace, name := pod.Namespace, pod.Name
+	started := false
+	err := retryOnError(ctx, podSimulatorBackoff, retriableWriteError, func() error {
+		if pod == nil {
+			var err error
+			if pod, err = s.cs.CoreV1().Pods(namespace).Get(ctx, name, metav1.GetOptions{}); err != nil {
+				return err
+			}
+			if !s.pending(pod) {
+				return nil
+			}
+		}
+		if _, err := s.cs.CoreV1().Pods(namespace).UpdateStatus(ctx, runningPod(pod), metav1.UpdateOptions{}); err != nil {
+			pod = nil
+			return err
+		}
+		started = true
+		return nil
+	})
+	if err != nil || !started {
+		return
+	}
+
+	if s.RunDuration > 0 && pod.Spec.RestartPolicy != corev1.RestartPolicyAlways {
+		time.AfterFunc(s.RunDuration, func() { s.succeed(ctx, namespace, name) })
+	}
+}
+
+func (s *PodSimulator) pending(pod *corev1.Pod) bool {
+	return s.nodes[pod.Spec.NodeName] && (pod.Status.Phase == corev1.PodPending || pod.Status.Phase == "")
+}
+
+// runningPod returns a copy of pod with the status of a started pod.
+func runningPod(pod *corev1.Pod) *corev1.Pod {
+	now := metav1.Now()
+	pod = pod.DeepCopy()
+	pod.Status.Phase = corev1.PodRunning
+	pod.Status.StartTime = &now
+	pod.Status.Conditions = []corev1.PodCondition{
+		{Type: corev1.PodScheduled, Status: corev1.ConditionTrue, LastTransitionTime: now},
+		{Type: corev1.PodInitialized, Status: corev1.ConditionTrue, LastTransitionTime: now},
+		{Type: corev1.ContainersReady, Status: corev1.ConditionTrue, LastTransitionTime: now},
+		{Type: corev1.PodReady, Status: corev1.ConditionTrue, LastTransitionTime: now},
+	}
+	return pod
+}
+
+// succeed moves a running pod to succeeded.
+func (s *PodSimulator) succeed(ctx context.Context, namespace, name string) {
+	_ = retryOnError(ctx, podSimulatorBackoff, retriableWriteError, func() error {
+		pod, err := s.cs.CoreV1().Pods(namespace).Get(ctx, name, metav1.GetOptions{})
+		if err != nil || pod.Status.Phase != corev1.PodRunning {
+			return err
+		}
+		pod.Status.Phase = corev1.PodSucceeded
+		for i := range pod.Status.Conditions {
+			switch pod.Status.Conditions[i].Type {
+			case corev1.PodReady, corev1.ContainersReady:
+				pod.Status.Conditions[i].Status = corev1.ConditionFalse
+			}
+		}
+		_, err = s.cs.CoreV1().Pods(namespace).UpdateStatus(ctx, pod, metav1.UpdateOptions{})
+		return err
+	})
+}
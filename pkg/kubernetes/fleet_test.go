@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"net/http"
+	"testing"
+	"time"
+
+	corev1 "k8s.io/api/core/v1"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/util/wait"
+)
+
+// TestPodSimulatorRetries checks that a pending pod is started and completed
+// although its status updates conflict or are throttled; the pod gets no
+// further events that would retry them.
+func TestPodSimulatorRetries(t *testing.T) {
+	server := newFakeAPIServer(t)
+	cs := server.clientset(t)
+	ctx, cancel := context.WithTimeout(context.Background(), 30*time.Second)
+	defer cancel()
+
+	fleet := GPUFleet{Nodes: 1}
+	server.add("v1", "nodes", fleet.NewNode(0))
+	server.Fail("PUT pods/status", http.StatusConflict, http.StatusTooManyRequests)
+
+	simCtx, stopSim := context.WithCancel(ctx)
+	defer stopSim()
+	go NewPodSimulator(cs, []string{fleet.WorkerName(0)}, 10*time.Millisecond).Run(simCtx)
+
+	pod := &corev1.Pod{
+		ObjectMeta: metav1.ObjectMeta{Name: "gpu-pod", Namespace: "default"},
+		Spec: corev1.PodSpec{
+			NodeName:      fleet.WorkerName(0),
+			RestartPolicy: corev1.RestartPolicyNever,
+			Containers:    []corev1.Container{{Name: "main", Image: "busybox"}},
+		},
+	}
+	if _, err := cs.CoreV1().Pods("default").Create(ctx, pod, metav1.CreateOptions{}); err != nil {
+		t.Fatal(err)
+	}
+
+	err := wait.PollUntilContextCancel(ctx, 10*time.Millisecond, true, func(ctx context.Context) (bool, error) {
+		pod, err := cs.CoreV1().Pods("default").Get(ctx, "gpu-pod", metav1.GetOptions{})
+		return err == nil && pod.Status.Phase == corev1.PodSucceeded, err
+	})
+	if err != nil {
+		t.Fatalf("pod did not succeed: %v", err)
+	}
+	// Two failed updates, then one to start and one to complete the pod.
+	if got := server.count("PUT pods/status"); got != 4 {
+		t.Errorf("got %d status updates, want 4", got)
+	}
+}
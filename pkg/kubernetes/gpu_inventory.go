@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"sort"
+
+	batchv1 "k8s.io/api/batch/v1"
+	corev1 "k8s.io/api/core/v1"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/labels"
+	clientset "k8s.io/client-go/kubernetes"
+)
+
+// GPUResource is the extended resource advertised by the NVIDIA device plugin.
+const GPUResource corev1.ResourceName = "nvidia.com/gpu"
+
+// activePodsSelector skips pods that no longer hold their resources.
+const activePodsSelector = "status.phase!=Succeeded,status.phase!=Failed"
+
+// PodLister lists pods from a local cache, such as the Lister returned by
+// the framework ClusterCache.
+type PodLister interface {
+	List(selector labels.Selector) ([]*corev1.Pod, error)
+}
+
+// NodeGPUs is the GPU usage of one node.
+type NodeGPUs struct {
+	Node        string
+	Allocatable int64
+	Used        int64
+	// Schedulable is false for nodes that do not accept new pods: cordoned
+	// and not ready nodes, and nodes with NoSchedule or NoExecute taints.
+	Schedulable bool
+}
+
+// Free returns the number of GPUs not requested by any active pod.
+func (n NodeGPUs) Free() int64 {
+	if free := n.Allocatable - n.Used; free > 0 {
+		return free
+	}
+	return 0
+}
+
+// GPUInventory is the GPU usage of the nodes with allocatable GPUs, sorted by
+// node name.
+type GPUInventory struct {
+	Nodes []NodeGPUs
+}
+
+// GetGPUInventory lists the nodes and active pods of the cluster and returns
+// their GPU inventory.
+func GetGPUInventory(ctx context.Context, cs clientset.Interface) (*GPUInventory, error) {
+	nodeList, err := cs.CoreV1().Nodes().List(ctx, metav1.ListOptions{})
+	if err != nil {
+		return nil, err
+	}
+	podList, err := cs.CoreV1().Pods(metav1.NamespaceAll).List(ctx, metav1.ListOptions{FieldSelector: activePodsSelector})
+	if err != nil {
+		return nil, err
+	}
+	nodes := make([]*corev1.Node, len(nodeList.Items))
+	for i := range nodeList.Items {
+		nodes[i] = &nodeList.Items[i]
+	}
+	pods := make([]*corev1.Pod, len(podList.Items))
+	for i := range podList.Items {
+		pods[i] = &podList.Items[i]
+	}
+	return NewGPUInventory(nodes, pods), nil
+}
+
+// GetGPUInventoryFromListers is like GetGPUInventory but reads the nodes and
+// pods from a local cache.
+func GetGPUInventoryFromListers(nodeLister NodeLister, podLister PodLister) (*GPUInventory, error) {
+	nodes, err := nodeLister.List(labels.Everything())
+	if err != nil {
+		return nil, err
+	}
+	pods, err := podLister.List(labels.Everything())
+	if err != nil {
+		return nil, err
+	}
+	return NewGPUInventory(nodes, pods), nil
+}
+
+// NewGPUInventory computes the GPUs used on every node from the requests of
+// the pods bound to it. Terminated pods are ignored.
+func NewGPUInventory(nodes []*corev1.Node, pods []*corev1.Pod) *GPUInventory {
+	byName := make(map[string]int, len(nodes))
+	inv := &GPUInventory{}
+	for _, node := range nodes {
+		allocatable := node.Status.Allocatable[GPUResource]
+		if allocatable.IsZero() {
+			continue
+		}
+		byName[node.Name] = len(inv.Nodes)
+		inv.Nodes = append(inv.Nodes, NodeGPUs{
+			Node:        node.Name,
+			Allocatable: allocatable.Value(),
+			Schedulable: schedulable(node),
+		})
+	}
+	for _, pod := range pods {
+		if pod.Spec.NodeName == "" || pod.Status.Phase == corev1.PodSucceeded || pod.Status.Phase == corev1.PodFailed {
+			continue
+		}
+		if i, ok := byName[pod.Spec.NodeName]; ok {
+			inv.Nodes[i].Used += podGPUs(&pod.Spec)
+		}
+	}
+	sort.Slice(inv.Nodes, func(i, j int) bool { return inv.Nodes[i].Node < inv.Nodes[j].Node })
+	return inv
+}
+
+// schedulable reports whether new pods can run on node. Placements bypass
+// the scheduler, so pods bound to a tainted or not ready node would be
+// rejected or evicted.
+func schedulable(node *corev1.Node) bool {
+	if node.Spec.Unschedulable {
+		return false
+	}
+	for _, taint := range node.Spec.Taints {
+		if taint.Effect == corev1.TaintEffectNoSchedule || taint.Effect == corev1.TaintEffectNoExecute {
+			return false
+		}
+	}
+	for _, c := range node.Status.Conditions {
+		if c.Type == corev1.NodeReady {
+			return c.Status == corev1.ConditionTrue
+		}
+	}
+	return false
+}
+
+// Free returns the total number of free GPUs on schedulable nodes.
+func (inv *GPUInventory) Free() int64 {
+	var free int64
+	for _, n := range inv.Nodes {
+		if n.Schedulable {
+			free += n.Free()
+		}
+	}
+	return free
+}
+
+// podGPUs returns the GPUs requested by a pod: the sum over its containers,
+// or the largest init container request if that is higher.
+func podGPUs(spec *corev1.PodSpec) int64 {
+	var sum, initMax int64
+	for i := range spec.Containers {
+		sum += containerGPUs(&spec.Containers[i])
+	}
+	for i := range spec.InitContainers {
+		if n := containerGPUs(&spec.InitContainers[i]); n > initMax {
+			initMax = n
+		}
+	}
+	if initMax > sum {
+		return initMax
+	}
+	return sum
+}
+
+// containerGPUs returns the GPU request of a container. Extended resources
+// must have equal requests and limits, and the request defaults to the limit.
+func containerGPUs(c *corev1.Container) int64 {
+	if q, ok := c.Resources.Requests[GPUResource]; ok {
+		return q.Value()
+	}
+	q := c.Resources.Limits[GPUResource]
+	return q.Value()
+}
+
+// PlacementMode selects how a planned placement is applied to a job.
+type PlacementMode int
+
+const (
+	// PlaceByNodeName binds the pods directly, bypassing the scheduler.
+	PlaceByNodeName PlacementMode = iota
+	// PlaceByAffinity requires the node through node affinity, so that the
+	// scheduler still admits the pods.
+	PlaceByAffinity
+)
+
+// Placement assigns a job to a node.
+type Placement struct {
+	Job  *batchv1.Job
+	Node string
+}
+
+// Apply pins the pods of the job to the planned node. With PlaceByAffinity
+// the node is added to every required node selector term of the job, so
+// the affinity the job already had still applies.
+func (p Placement) Apply(mode PlacementMode) {
+	spec := &p.Job.Spec.Template.Spec
+	if mode == PlaceByNodeName {
+		spec.NodeName = p.Node
+		return
+	}
+	if spec.Affinity == nil {
+		spec.Affinity = &corev1.Affinity{}
+	}
+	if spec.Affinity.NodeAffinity == nil {
+		spec.Affinity.NodeAffinity = &corev1.NodeAffinity{}
+	}
+	required := spec.Affinity.NodeAffinity.RequiredDuringSchedulingIgnoredDuringExecution
+	if required == nil || len(required.NodeSelectorTerms) == 0 {
+		required = &corev1.NodeSelector{NodeSelectorTerms: []corev1.NodeSelectorTerm{{}}}
+		spec.Affinity.NodeAffinity.RequiredDuringSchedulingIgnoredDuringExecution = required
+	}
+	// Terms are ORed and the requirements of a term ANDed.
+	for i := range required.NodeSelectorTerms {
+		term := &required.NodeSelectorTerms[i]
+		term.MatchFields = append(term.MatchFields, corev1.NodeSelectorRequirement{
+			Key:      "metadata.name",
+			Operator: corev1.NodeSelectorOpIn,
+			Values:   []string{p.Node},
+		})
+	}
+}
+
+// Plan assigns jobs to schedulable nodes with free GPUs using best-fit
+// decreasing bin packing: the largest jobs are placed first, each on the node
+// where it leaves the fewest GPUs unused. All pods a job runs at once are
+// placed on the same node. Jobs that do not fit are returned as unplaced, so
+// the caller can run them in a later batch instead of leaving them Pending.
+// The inventory itself is not changed.
+func (inv *GPUInventory) Plan(jobs []*batchv1.Job) ([]Placement, []*batchv1.Job) {
+	// Unschedulable nodes are left out rather than given no capacity, jobs
+	// without GPUs would fit on them.
+	var candidates []int
+	free := make([]int64, len(inv.Nodes))
+	for i, n := range inv.Nodes {
+		if n.Schedulable {
+			candidates = append(candidates, i)
+			free[i] = n.Free()
+		}
+	}
+
+	order := make([]int, len(jobs))
+	demand := make([]int64, len(jobs))
+	for i, job := range jobs {
+		order[i] = i
+		demand[i] = jobGPUs(job)
+	}
+	sort.SliceStable(order, func(a, b int) bool { return demand[order[a]] > demand[order[b]] })
+
+	var placed []Placement
+	var unplaced []*batchv1.Job
+	for _, j := range order {
+		best := -1
+		for _, i := range candidates {
+			if free[i] >= demand[j] && (best < 0 || free[i] < free[best]) {
+				best = i
+			}
+		}
+		if best < 0 {
+			unplaced = append(unplaced, jobs[j])
+			continue
+		}
+		free[best] -= demand[j]
+		placed = append(placed, Placement{Job: jobs[j], Node: inv.Nodes[best].Node})
+	}
+	return placed, unplaced
+}
+
+// jobGPUs returns the GPUs a job holds at once: the request of its pod times
+// its parallelism.
+func jobGPUs(job *batchv1.Job) int64 {
+	parallelism := int64(1)
+	if job.Spec.Parallelism != nil {
+		parallelism = int64(*job.Spec.Parallelism)
+	}
+	if job.Spec.Completions != nil && int64(*job.Spec.Completions) < parallelism {
+		parallelism = int64(*job.Spec.Completions)
+	}
+	return podGPUs(&job.Spec.Template.Spec) * parallelism
+}
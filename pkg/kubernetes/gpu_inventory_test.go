@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"testing"
+
+	batchv1 "k8s.io/api/batch/v1"
+	corev1 "k8s.io/api/core/v1"
+)
+
+func TestNewGPUInventorySchedulable(t *testing.T) {
+	fleet := GPUFleet{Nodes: 6}
+	nodes := make([]*corev1.Node, fleet.Nodes)
+	for i := range nodes {
+		nodes[i] = fleet.NewNode(i)
+	}
+	nodes[1].Spec.Unschedulable = true
+	nodes[2].Status.Conditions[0].Status = corev1.ConditionFalse
+	nodes[3].Spec.Taints = []corev1.Taint{{Key: "gpu-maintenance", Effect: corev1.TaintEffectNoSchedule}}
+	nodes[4].Spec.Taints = []corev1.Taint{{Key: "node.kubernetes.io/unreachable", Effect: corev1.TaintEffectNoExecute}}
+	nodes[5].Spec.Taints = []corev1.Taint{{Key: "gpu-busy", Effect: corev1.TaintEffectPreferNoSchedule}}
+
+	inv := NewGPUInventory(nodes, nil)
+	want := map[string]bool{
+		nodes[0].Name: true,
+		nodes[1].Name: false,
+		nodes[2].Name: false,
+		nodes[3].Name: false,
+		nodes[4].Name: false,
+		nodes[5].Name: true,
+	}
+	for _, n := range inv.Nodes {
+		if n.Schedulable != want[n.Node] {
+			t.Errorf("node %s schedulable %v, want %v", n.Node, n.Schedulable, want[n.Node])
+		}
+	}
+}
+
+func TestPlacementApplyKeepsAffinity(t *testing.T) {
+	job := NewGPUJob("affine", "", 1)
+	job.Spec.Template.Spec.Affinity = &corev1.Affinity{NodeAffinity: &corev1.NodeAffinity{
+		RequiredDuringSchedulingIgnoredDuringExecution: &corev1.NodeSelector{
+			NodeSelectorTerms: []corev1.NodeSelectorTerm{
+				{MatchExpressions: []corev1.NodeSelectorRequirement{{Key: "gpu.product", Operator: corev1.NodeSelectorOpIn, Values: []string{"A100"}}}},
+				{MatchExpressions: []corev1.NodeSelectorRequirement{{Key: "gpu.product", Operator: corev1.NodeSelectorOpIn, Values: []string{"H100"}}}},
+			},
+		},
+	}}
+
+	Placement{Job: job, Node: "gpu-node-1"}.Apply(PlaceByAffinity)
+
+	terms := job.Spec.Template.Spec.Affinity.NodeAffinity.RequiredDuringSchedulingIgnoredDuringExecution.NodeSelectorTerms
+	if len(terms) != 2 {
+		t.Fatalf("got %d node selector terms, want 2", len(terms))
+	}
+	for i, term := range terms {
+		if len(term.MatchExpressions) != 1 {
+			t.Errorf("term %d lost its expressions: %+v", i, term)
+		}
+		if len(term.MatchFields) != 1 || term.MatchFields[0].Values[0] != "gpu-node-1" {
+			t.Errorf("term %d does not require the planned node: %+v", i, term)
+		}
+	}
+
+	bare := NewGPUJob("bare", "", 1)
+	Placement{Job: bare, Node: "gpu-node-2"}.Apply(PlaceByAffinity)
+	terms = bare.Spec.Template.Spec.Affinity.NodeAffinity.RequiredDuringSchedulingIgnoredDuringExecution.NodeSelectorTerms
+	if len(terms) != 1 || len(terms[0].MatchFields) != 1 || terms[0].MatchFields[0].Values[0] != "gpu-node-2" {
+		t.Errorf("got terms %+v, want one requiring gpu-node-2", terms)
+	}
+}
+
+func TestPlanSkipsCordonedNodes(t *testing.T) {
+	inv := &GPUInventory{Nodes: []NodeGPUs{
+		{Node: "cordoned", Allocatable: 8, Schedulable: false},
+		{Node: "worker", Allocatable: 8, Used: 4, Schedulable: true},
+	}}
+	noGPU := NewGPUJob("no-gpu", "", 1)
+	noGPU.Spec.Template.Spec.Containers[0].Resources = corev1.ResourceRequirements{}
+	jobs := []*batchv1.Job{
+		noGPU,
+		NewGPUJob("four-gpus", "", 4),
+		NewGPUJob("eight-gpus", "", 8),
+	}
+
+	placed, unplaced := inv.Plan(jobs)
+	for _, p := range placed {
+		if p.Node != "worker" {
+			t.Errorf("job %s placed on %s", p.Job.Name, p.Node)
+		}
+	}
+	if len(placed) != 2 {
+		t.Errorf("placed %d jobs, want 2", len(placed))
+	}
+	if len(unplaced) != 1 || unplaced[0].Name != "eight-gpus" {
+		t.Errorf("unplaced %v, want eight-gpus", unplaced)
+	}
+}
@@ -17,8 +17,6 @@
 package kubernetes
 
 import (
-	"fmt"
-
 	batchv1 "k8s.io/api/batch/v1"
 	v1 "k8s.io/api/core/v1"
 	"k8s.io/apimachinery/pkg/api/resource"
@@ -54,7 +52,7 @@ func NewGPUJob(name string, image string, gpuCount int) *batchv1.Job {
 							Image: image,
 							Resources: v1.ResourceRequirements{
 								Limits: v1.ResourceList{
-									"nvidia.com/gpu": resource.MustParse(fmt.Sprintf("%d", gpuCount)),
+									"nvidia.com/gpu": *resource.NewQuantity(int64(gpuCount), resource.DecimalSI),
 								},
 							},
 						},
@@ -71,3 +69,46 @@ func NewGPUJob(name string, image string, gpuCount int) *batchv1.Job {
 		},
 	}
 }
+
+// IndexedGPUJobSpec configures the Job built by NewIndexedGPUJob.
+type IndexedGPUJobSpec struct {
+	Name  string
+	Image string
+	// GPUCount is the number of GPUs requested by the pod of every index.
+	GPUCount int
+	// Completions is the number of indexes to complete. Defaults to 1.
+	Completions int32
+	// Parallelism is the number of indexes running at once. Defaults to
+	// Completions.
+	Parallelism int32
+	// BackoffLimit is the number of retries of the whole Job, nil keeps the
+	// API server default.
+	BackoffLimit *int32
+	// BackoffLimitPerIndex is the number of retries of every index, nil
+	// disables per-index retries.
+	BackoffLimitPerIndex *int32
+	// TTLSecondsAfterFinished deletes the Job and its pods after it finished,
+	// nil keeps them.
+	TTLSecondsAfterFinished *int32
+}
+
+// NewIndexedGPUJob creates an Indexed GPU job running the vectoradd sample
+// once per completion index, so that a single object drives many GPU pods.
+// Every pod sees its index in the JOB_COMPLETION_INDEX environment variable.
+func NewIndexedGPUJob(spec IndexedGPUJobSpec) *batchv1.Job {
+	if spec.Completions <= 0 {
+		spec.Completions = 1
+	}
+	if spec.Parallelism <= 0 {
+		spec.Parallelism = spec.Completions
+	}
+	job := NewGPUJob(spec.Name, spec.Image, spec.GPUCount)
+	mode := batchv1.IndexedCompletion
+	job.Spec.CompletionMode = &mode
+	job.Spec.Completions = &spec.Completions
+	job.Spec.Parallelism = &spec.Parallelism
+	job.Spec.BackoffLimit = spec.BackoffLimit
+	job.Spec.BackoffLimitPerIndex = spec.BackoffLimitPerIndex
+	job.Spec.TTLSecondsAfterFinished = spec.TTLSecondsAfterFinished
+	return job
+}
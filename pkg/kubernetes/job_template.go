@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"fmt"
+	"maps"
+	"strconv"
+	"strings"
+
+	"golang.org/x/sync/errgroup"
+	"golang.org/x/time/rate"
+	batchv1 "k8s.io/api/batch/v1"
+	corev1 "k8s.io/api/core/v1"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	clientset "k8s.io/client-go/kubernetes"
+)
+
+// JobTemplate is a Job that is validated once and then stamped out for every
+// object created from it. Stamped jobs share the specs of the template, so
+// creating one costs a few allocations instead of a DeepCopy.
+type JobTemplate struct {
+	job *batchv1.Job
+}
+
+// NewJobTemplate validates job and returns a template for it. The template
+// keeps its own copy, later changes to job do not affect it.
+func NewJobTemplate(job *batchv1.Job) (*JobTemplate, error) {
+	if job.Name == "" && job.GenerateName == "" {
+		return nil, fmt.Errorf("job template has no name")
+	}
+	pod := job.Spec.Template.Spec
+	if len(pod.Containers) == 0 {
+		return nil, fmt.Errorf("job template %s has no containers", job.Name)
+	}
+	for _, c := range pod.Containers {
+		if c.Image == "" {
+			return nil, fmt.Errorf("container %s of job template %s has no image", c.Name, job.Name)
+		}
+	}
+	switch pod.RestartPolicy {
+	case corev1.RestartPolicyNever, corev1.RestartPolicyOnFailure:
+	default:
+		return nil, fmt.Errorf("job template %s has unsupported restart policy %q", job.Name, pod.RestartPolicy)
+	}
+	return &JobTemplate{job: job.DeepCopy()}, nil
+}
+
+// New returns a job stamped from the template, named name. An empty name
+// keeps the name of the template. The labels and annotations of the job and
+// of its pod template belong to the job; everything else, e.g. the pod spec,
+// is shared with the template and must not be modified. DeepCopy a job that
+// needs other changes.
+func (t *JobTemplate) New(name string) *batchv1.Job {
+	job := *t.job
+	job.ObjectMeta = stampMeta(t.job.ObjectMeta)
+	job.Spec.Template.ObjectMeta = stampMeta(t.job.Spec.Template.ObjectMeta)
+	if name != "" {
+		job.Name = name
+	}
+	return &job
+}
+
+// NewIndexed returns a job stamped from the template whose name is suffixed
+// with index, see New.
+// A template with only a GenerateName is named after its GenerateName.
+func (t *JobTemplate) NewIndexed(index int) *batchv1.Job {
+	base := t.job.Name
+	if base == "" {
+		base = strings.TrimSuffix(t.job.GenerateName, "-")
+	}
+	job := t.New(base + "-" + strconv.Itoa(index))
+	job.GenerateName = ""
+	return job
+}
+
+func stampMeta(meta metav1.ObjectMeta) metav1.ObjectMeta {
+	meta.Labels = maps.Clone(meta.Labels)
+	meta.Annotations = maps.Clone(meta.Annotations)
+	return meta
+}
+
+// CreateJobsOptions bounds the API load of CreateJobs.
+type CreateJobsOptions struct {
+	// Concurrency is the maximum number of create requests in flight.
+	// Defaults to 1.
+	Concurrency int
+	// QPS is the maximum number of create requests started per second. Zero
+	// disables rate limiting.
+	QPS float64
+}
+
+// CreateJobs creates jobs in namespace and returns the created objects in the
+// order of jobs. It stops at the first error.
+func CreateJobs(ctx context.Context, cs clientset.Interface, namespace string, jobs []*batchv1.Job, opts CreateJobsOptions) ([]*batchv1.Job, error) {
+	if opts.Concurrency <= 0 {
+		opts.Concurrency = 1
+	}
+	limit := rate.Inf
+	if opts.QPS > 0 {
+		limit = rate.Limit(opts.QPS)
+	}
+	limiter := rate.NewLimiter(limit, 1)
+	client := cs.BatchV1().Jobs(namespace)
+
+	created := make([]*batchv1.Job, len(jobs))
+	g, gctx := errgroup.WithContext(ctx)
+	g.SetLimit(opts.Concurrency)
+	var waitErr error
+	for i, job := range jobs {
+		if waitErr = limiter.Wait(gctx); waitErr != nil {
+			break
+		}
+		i, job := i, job
+		g.Go(func() error {
+			out, err := client.Create(gctx, job, metav1.CreateOptions{})
+			if err != nil {
+				return fmt.Errorf("error creating job %s: %w", job.Name, err)
+			}
+			created[i] = out
+			return nil
+		})
+	}
+	if err := g.Wait(); err != nil {
+		return nil, err
+	}
+	if waitErr != nil {
+		return nil, waitErr
+	}
+	return created, nil
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"strconv"
+	"testing"
+
+	batchv1 "k8s.io/api/batch/v1"
+)
+
+func TestJobTemplateNewIndexed(t *testing.T) {
+	for _, tc := range []struct {
+		name, generateName, want string
+	}{
+		{name: "gpu", want: "gpu-3"},
+		{generateName: "gpu-", want: "gpu-3"},
+		{generateName: "gpu", want: "gpu-3"},
+	} {
+		job := NewGPUJob("", "", 1)
+		job.Name, job.GenerateName = tc.name, tc.generateName
+		template, err := NewJobTemplate(job)
+		if err != nil {
+			t.Fatal(err)
+		}
+		got := template.NewIndexed(3)
+		if got.Name != tc.want || got.GenerateName != "" {
+			t.Errorf("name %q, generateName %q: got name %q, generateName %q; want %q", tc.name, tc.generateName, got.Name, got.GenerateName, tc.want)
+		}
+	}
+}
+
+func TestJobTemplateStampsMetadata(t *testing.T) {
+	job := NewGPUJob("gpu", "", 1)
+	job.Spec.Template.Labels = map[string]string{"app": "gpu"}
+	template, err := NewJobTemplate(job)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	first, second := template.NewIndexed(0), template.NewIndexed(1)
+	first.Labels = map[string]string{"job": first.Name}
+	first.Spec.Template.Labels["app"] = first.Name
+	if got := second.Spec.Template.Labels["app"]; got != "gpu" {
+		t.Errorf("pod labels of another job changed to %q", got)
+	}
+	if got := template.New("").Spec.Template.Labels["app"]; got != "gpu" {
+		t.Errorf("pod labels of the template changed to %q", got)
+	}
+	if second.Labels != nil {
+		t.Errorf("labels of another job changed to %v", second.Labels)
+	}
+	if first.Name != "gpu-0" || second.Name != "gpu-1" || template.New("").Name != "gpu" {
+		t.Errorf("got names %q and %q", first.Name, second.Name)
+	}
+}
+
+// jobSink keeps the compiler from optimizing away the benchmarked calls.
+var jobSink *batchv1.Job
+
+// BenchmarkJobTemplate compares stamping jobs from a validated template with
+// deep copying a job and with building every job from scratch.
+func BenchmarkJobTemplate(b *testing.B) {
+	b.Run("Stamp", func(b *testing.B) {
+		template, err := NewJobTemplate(NewGPUJob("gpu-job", "", 1))
+		if err != nil {
+			b.Fatal(err)
+		}
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			jobSink = template.NewIndexed(i)
+		}
+	})
+	b.Run("DeepCopy", func(b *testing.B) {
+		job := NewGPUJob("gpu-job", "", 1)
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			jobSink = job.DeepCopy()
+			jobSink.Name = "gpu-job-" + strconv.Itoa(i)
+		}
+	})
+	b.Run("Rebuild", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			jobSink = NewGPUJob("gpu-job-"+strconv.Itoa(i), "", 1)
+		}
+	})
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"testing"
+
+	batchv1 "k8s.io/api/batch/v1"
+	"k8s.io/utils/ptr"
+)
+
+func TestNewIndexedGPUJob(t *testing.T) {
+	for _, tc := range []struct {
+		name            string
+		spec            IndexedGPUJobSpec
+		wantCompletions int32
+		wantParallelism int32
+		wantGPUs        int64
+	}{
+		{name: "defaults", wantCompletions: 1, wantParallelism: 1, wantGPUs: 1},
+		{name: "parallelism defaults to completions", spec: IndexedGPUJobSpec{Completions: 8}, wantCompletions: 8, wantParallelism: 8, wantGPUs: 1},
+		{name: "bounded parallelism", spec: IndexedGPUJobSpec{Completions: 8, Parallelism: 2, GPUCount: 4}, wantCompletions: 8, wantParallelism: 2, wantGPUs: 4},
+		{name: "retries", spec: IndexedGPUJobSpec{Completions: 2, BackoffLimit: ptr.To[int32](3), BackoffLimitPerIndex: ptr.To[int32](1), TTLSecondsAfterFinished: ptr.To[int32](60)}, wantCompletions: 2, wantParallelism: 2, wantGPUs: 1},
+	} {
+		t.Run(tc.name, func(t *testing.T) {
+			job := NewIndexedGPUJob(tc.spec)
+			if mode := job.Spec.CompletionMode; mode == nil || *mode != batchv1.IndexedCompletion {
+				t.Errorf("got completion mode %v, want Indexed", mode)
+			}
+			if got := job.Spec.Completions; got == nil || *got != tc.wantCompletions {
+				t.Errorf("got completions %v, want %d", got, tc.wantCompletions)
+			}
+			if got := job.Spec.Parallelism; got == nil || *got != tc.wantParallelism {
+				t.Errorf("got parallelism %v, want %d", got, tc.wantParallelism)
+			}
+			containers := job.Spec.Template.Spec.Containers
+			if len(containers) != 1 {
+				t.Fatalf("got %d containers, want 1", len(containers))
+			}
+			gpus := containers[0].Resources.Limits["nvidia.com/gpu"]
+			if gpus.Value() != tc.wantGPUs {
+				t.Errorf("got %s GPUs, want %d", gpus.String(), tc.wantGPUs)
+			}
+			if job.Spec.BackoffLimit != tc.spec.BackoffLimit ||
+				job.Spec.BackoffLimitPerIndex != tc.spec.BackoffLimitPerIndex ||
+				job.Spec.TTLSecondsAfterFinished != tc.spec.TTLSecondsAfterFinished {
+				t.Error("backoff limits or TTL not taken from the spec")
+			}
+		})
+	}
+}
@@ -19,27 +19,48 @@ package kubernetes
 import (
 	"context"
 	"fmt"
-	"strings"
-	"time"
 
 	"github.com/onsi/ginkgo/v2"
 	"github.com/onsi/gomega"
 
 	corev1 "k8s.io/api/core/v1"
-	"k8s.io/apimachinery/pkg/api/errors"
 	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/labels"
 	clientset "k8s.io/client-go/kubernetes"
-	nfdv1alpha1 "sigs.k8s.io/node-feature-discovery/pkg/apis/nfd/v1alpha1"
 	nfdclient "sigs.k8s.io/node-feature-discovery/pkg/generated/clientset/versioned"
 )
 
+// NodeLister lists nodes from a local cache, such as the Lister returned by
+// the framework ClusterCache.
+type NodeLister interface {
+	List(selector labels.Selector) ([]*corev1.Node, error)
+}
+
 // GetNonControlPlaneNodes gets the nodes that are not tainted for exclusive control-plane usage
 func GetNonControlPlaneNodes(ctx context.Context, cli clientset.Interface) ([]corev1.Node, error) {
 	nodeList, err := cli.CoreV1().Nodes().List(ctx, metav1.ListOptions{})
 	if err != nil {
 		return nil, err
 	}
-	if len(nodeList.Items) == 0 {
+	return nonControlPlaneNodes(nodeList.Items)
+}
+
+// GetNonControlPlaneNodesFromLister is like GetNonControlPlaneNodes but reads
+// the nodes from a local cache instead of the API server.
+func GetNonControlPlaneNodesFromLister(lister NodeLister) ([]corev1.Node, error) {
+	cached, err := lister.List(labels.Everything())
+	if err != nil {
+		return nil, err
+	}
+	nodes := make([]corev1.Node, 0, len(cached))
+	for _, node := range cached {
+		nodes = append(nodes, *node.DeepCopy())
+	}
+	return nonControlPlaneNodes(nodes)
+}
+
+func nonControlPlaneNodes(nodes []corev1.Node) ([]corev1.Node, error) {
+	if len(nodes) == 0 {
 		return nil, fmt.Errorf("no nodes found in the cluster")
 	}
 
@@ -48,7 +69,7 @@ func GetNonControlPlaneNodes(ctx context.Context, cli clientset.Interface) ([]co
 		Key:    "node-role.kubernetes.io/control-plane",
 	}
 	out := []corev1.Node{}
-	for _, node := range nodeList.Items {
+	for _, node := range nodes {
 		if !TaintExists(node.Spec.Taints, &controlPlaneTaint) {
 			out = append(out, node)
 		}
@@ -60,6 +81,8 @@ func GetNonControlPlaneNodes(ctx context.Context, cli clientset.Interface) ([]co
 	return out, nil
 }
 
+// GetNode returns the named node from nodes, or a zero Node if it is missing.
+// Use a NodeSet to look up many nodes of a large list.
 func GetNode(nodes []corev1.Node, nodeName string) corev1.Node {
 	for _, node := range nodes {
 		if node.Name == nodeName {
@@ -70,146 +93,30 @@ func GetNode(nodes []corev1.Node, nodeName string) corev1.Node {
 }
 
 // CleanupNode deletes all NFD/GFD related metadata from the Node object, i.e.
-// labels and annotations
+// labels and annotations. Nodes are cleaned up concurrently with patches, so
+// concurrent writers like the NFD worker do not cause conflicts.
 func CleanupNode(ctx context.Context, cs clientset.Interface) {
-	// Per-node cleanup function
-	cleanup := func(nodeName string) error {
-		node, err := cs.CoreV1().Nodes().Get(ctx, nodeName, metav1.GetOptions{})
-		gomega.Expect(err).NotTo(gomega.HaveOccurred())
-
-		update := false
-		updateStatus := false
-		// Gather info about all NFD-managed node assets outside the default prefix
-		nfdLabels := map[string]struct{}{}
-		for _, name := range strings.Split(node.Annotations[nfdv1alpha1.FeatureLabelsAnnotation], ",") {
-			if strings.Contains(name, "/") {
-				nfdLabels[name] = struct{}{}
-			}
-		}
-		nfdERs := map[string]struct{}{}
-		for _, name := range strings.Split(node.Annotations[nfdv1alpha1.ExtendedResourceAnnotation], ",") {
-			if strings.Contains(name, "/") {
-				nfdERs[name] = struct{}{}
-			}
-		}
-
-		// Remove labels
-		for key := range node.Labels {
-			_, ok := nfdLabels[key]
-			if ok || strings.HasPrefix(key, nfdv1alpha1.FeatureLabelNs) {
-				delete(node.Labels, key)
-				update = true
-			}
-		}
-
-		// Remove annotations
-		for key := range node.Annotations {
-			if strings.HasPrefix(key, nfdv1alpha1.AnnotationNs) {
-				delete(node.Annotations, key)
-				update = true
-			}
-		}
-
-		// Remove taints
-		for _, taint := range node.Spec.Taints {
-			taint := taint
-			if strings.HasPrefix(taint.Key, nfdv1alpha1.TaintNs) {
-				newTaints, removed := DeleteTaint(node.Spec.Taints, &taint)
-				if removed {
-					node.Spec.Taints = newTaints
-					update = true
-				}
-			}
-		}
-
-		// Remove extended resources
-		for key := range node.Status.Capacity {
-			// We check for FeatureLabelNs as -resource-labels can create ERs there
-			_, ok := nfdERs[string(key)]
-			if ok || strings.HasPrefix(string(key), nfdv1alpha1.FeatureLabelNs) {
-				delete(node.Status.Capacity, key)
-				delete(node.Status.Allocatable, key)
-				updateStatus = true
-			}
-		}
-
-		if updateStatus {
-			ginkgo.By("Deleting NFD extended resources from node " + nodeName)
-			if _, err := cs.CoreV1().Nodes().UpdateStatus(ctx, node, metav1.UpdateOptions{}); err != nil {
-				return err
-			}
-		}
-
-		if update {
-			ginkgo.By("Deleting NFD labels, annotations and taints from node " + node.Name)
-			if _, err := cs.CoreV1().Nodes().Update(ctx, node, metav1.UpdateOptions{}); err != nil {
-				return err
-			}
-		}
-		return nil
-	}
-
-	// Cleanup all nodes
-	nodeList, err := cs.CoreV1().Nodes().List(ctx, metav1.ListOptions{})
-	gomega.Expect(err).NotTo(gomega.HaveOccurred())
-
-	for _, n := range nodeList.Items {
-		var err error
-		for retry := 0; retry < 5; retry++ {
-			if err = cleanup(n.Name); err == nil {
-				break
-			}
-			time.Sleep(100 * time.Millisecond)
-		}
-		gomega.Expect(err).NotTo(gomega.HaveOccurred())
-	}
+	ginkgo.By("Deleting NFD labels, annotations, taints and extended resources from nodes")
+	gomega.Expect(CleanupNodes(ctx, cs, CleanupOptions{})).To(gomega.Succeed())
 }
 
-func CleanupNFDObjects(ctx context.Context, cli *nfdclient.Clientset, namespace string) {
-	cleanupNodeFeatureRules(ctx, cli)
-	cleanupNodeFeatures(ctx, cli, namespace)
+// CleanupNodeFromCache is like CleanupNode but starts from the nodes of a
+// local cache, e.g. the framework ClusterCache, instead of listing them.
+// Metadata the cache has not observed yet is left in place.
+func CleanupNodeFromCache(ctx context.Context, cs clientset.Interface, lister NodeLister) {
+	ginkgo.By("Deleting NFD labels, annotations, taints and extended resources from nodes")
+	gomega.Expect(CleanupNodesFromLister(ctx, cs, lister, CleanupOptions{})).To(gomega.Succeed())
 }
 
-// cleanupNodeFeatures deletes all NodeFeature objects in the given namespace
-func cleanupNodeFeatures(ctx context.Context, cli *nfdclient.Clientset, namespace string) {
-	nfs, err := cli.NfdV1alpha1().NodeFeatures(namespace).List(ctx, metav1.ListOptions{})
-	if errors.IsNotFound(err) {
-		// Omitted error, nothing to do.
-		return
-	}
-	gomega.Expect(err).NotTo(gomega.HaveOccurred())
-
-	if len(nfs.Items) != 0 {
-		ginkgo.By("[Cleanup]\tDeleting NodeFeature objects from namespace " + namespace)
-		for _, nf := range nfs.Items {
-			err = cli.NfdV1alpha1().NodeFeatures(namespace).Delete(ctx, nf.Name, metav1.DeleteOptions{})
-			if errors.IsNotFound(err) {
-				// Omitted error
-				continue
-			}
-			gomega.Expect(err).NotTo(gomega.HaveOccurred())
-		}
-	}
+// CleanupNFDObjects deletes all NodeFeatureRule objects and the NodeFeature
+// objects of the given namespace, and waits until they are gone.
+func CleanupNFDObjects(ctx context.Context, cli nfdclient.Interface, namespace string) {
+	CleanupNFDObjectsWithSelector(ctx, cli, namespace, "")
 }
 
-// cleanupNodeFeatureRules deletes all NodeFeatureRule objects
-func cleanupNodeFeatureRules(ctx context.Context, cli *nfdclient.Clientset) {
-	nfrs, err := cli.NfdV1alpha1().NodeFeatureRules().List(ctx, metav1.ListOptions{})
-	if errors.IsNotFound(err) {
-		// Omitted error, nothing to do.
-		return
-	}
-	gomega.Expect(err).NotTo(gomega.HaveOccurred())
-
-	if len(nfrs.Items) != 0 {
-		ginkgo.By("[Cleanup]\tDeleting NodeFeatureRule objects from the cluster")
-		for _, nfr := range nfrs.Items {
-			err = cli.NfdV1alpha1().NodeFeatureRules().Delete(ctx, nfr.Name, metav1.DeleteOptions{})
-			if errors.IsNotFound(err) {
-				// Omitted error
-				continue
-			}
-			gomega.Expect(err).NotTo(gomega.HaveOccurred())
-		}
-	}
+// CleanupNFDObjectsWithSelector is like CleanupNFDObjects but only deletes
+// the objects matching labelSelector.
+func CleanupNFDObjectsWithSelector(ctx context.Context, cli nfdclient.Interface, namespace, labelSelector string) {
+	ginkgo.By("[Cleanup]\tDeleting NodeFeatureRule objects and NodeFeature objects from namespace " + namespace)
+	gomega.Expect(DeleteNFDObjects(ctx, cli, namespace, CleanupOptions{LabelSelector: labelSelector})).To(gomega.Succeed())
 }
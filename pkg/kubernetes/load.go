@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"fmt"
+	"math"
+	"sort"
+	"sync"
+	"time"
+
+	"golang.org/x/time/rate"
+	corev1 "k8s.io/api/core/v1"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/runtime"
+	"k8s.io/apimachinery/pkg/watch"
+	clientset "k8s.io/client-go/kubernetes"
+	"k8s.io/client-go/tools/cache"
+)
+
+// LoadJobLabel is set on the pods of jobs created by RunGPUJobLoad to the
+// name of their job.
+const LoadJobLabel = "e2e-load-job"
+
+// GPUJobLoad describes a burst of GPU jobs created by RunGPUJobLoad.
+type GPUJobLoad struct {
+	// Jobs is the number of jobs to create.
+	Jobs int
+	// Rate is the number of jobs created per second. Zero creates them as
+	// fast as the client allows.
+	Rate float64
+	// GPUCount is the number of GPUs requested by every job.
+	GPUCount int
+	// Image overrides the default vectoradd image of NewGPUJob.
+	Image string
+	// NamePrefix prefixes the job names, which are suffixed with their index.
+	NamePrefix string
+	// Pods creates the pod of every job directly instead of the Job, for
+	// clusters without a Job controller such as a SimulatedCluster. The
+	// pods are bound to Nodes round-robin, so that a PodSimulator for those
+	// nodes runs them.
+	Pods  bool
+	Nodes []string
+}
+
+// LatencySummary holds percentiles of one scheduling latency, in seconds.
+type LatencySummary struct {
+	Count int     `json:"count"`
+	P50   float64 `json:"p50Seconds"`
+	P90   float64 `json:"p90Seconds"`
+	P99   float64 `json:"p99Seconds"`
+	Max   float64 `json:"maxSeconds"`
+}
+
+// GPUJobLoadReport is the result of RunGPUJobLoad.
+type GPUJobLoadReport struct {
+	Jobs      int `json:"jobs"`
+	Completed int `json:"completed"`
+	Failed    int `json:"failed"`
+
+	CreateToScheduled  LatencySummary `json:"createToScheduled"`
+	ScheduledToRunning LatencySummary `json:"scheduledToRunning"`
+	RunningToCompleted LatencySummary `json:"runningToCompleted"`
+}
+
+// podTimeline records when the pod of a load job was observed in each state.
+type podTimeline struct {
+	created, scheduled, running, finished time.Time
+	failed                                bool
+}
+
+// RunGPUJobLoad creates load.Jobs GPU jobs in namespace at load.Rate and
+// watches their pods until every job finished or ctx is done. Times are taken
+// when the client observes a transition, so the report only depends on pod
+// status updates. Clusters without GPUs work as well, and fake or simulated
+// clusters without a Job controller with load.Pods and a PodSimulator. The
+// jobs or pods are left in place for the caller to clean up.
+func RunGPUJobLoad(ctx context.Context, cs clientset.Interface, namespace string, load GPUJobLoad) (*GPUJobLoadReport, error) {
+	if load.Jobs <= 0 {
+		return nil, fmt.Errorf("invalid number of jobs %d", load.Jobs)
+	}
+	if load.Pods && len(load.Nodes) == 0 {
+		return nil, fmt.Errorf("creating pods directly needs nodes to bind them to")
+	}
+	if load.NamePrefix == "" {
+		load.NamePrefix = "gpu-load"
+	}
+
+	var (
+		mu        sync.Mutex
+		timelines = make(map[string]*podTimeline, load.Jobs)
+		finished  = make(chan struct{})
+		remaining = load.Jobs
+	)
+	observe := func(obj interface{}) {
+		pod, ok := obj.(*corev1.Pod)
+		if !ok {
+			return
+		}
+		now := time.Now()
+		mu.Lock()
+		defer mu.Unlock()
+		t, ok := timelines[pod.Labels[LoadJobLabel]]
+		if !ok || !t.finished.IsZero() {
+			return
+		}
+		if t.scheduled.IsZero() && podScheduled(pod) {
+			t.scheduled = now
+		}
+		switch pod.Status.Phase {
+		case corev1.PodRunning:
+			if t.running.IsZero() {
+				t.running = now
+			}
+		case corev1.PodSucceeded, corev1.PodFailed:
+			t.finished = now
+			t.failed = pod.Status.Phase == corev1.PodFailed
+			remaining--
+			if remaining == 0 {
+				close(finished)
+			}
+		}
+	}
+
+	pods := cs.CoreV1().Pods(namespace)
+	informer := cache.NewSharedIndexInformer(&cache.ListWatch{
+		ListFunc: func(options metav1.ListOptions) (runtime.Object, error) {
+			options.LabelSelector = LoadJobLabel
+			return pods.List(ctx, options)
+		},
+		WatchFunc: func(options metav1.ListOptions) (watch.Interface, error) {
+			options.LabelSelector = LoadJobLabel
+			return pods.Watch(ctx, options)
+		},
+	}, &corev1.Pod{}, 0, cache.Indexers{})
+	if _, err := informer.AddEventHandler(cache.ResourceEventHandlerFuncs{
+		AddFunc:    observe,
+		UpdateFunc: func(_, obj interface{}) { observe(obj) },
+	}); err != nil {
+		return nil, err
+	}
+	stop := make(chan struct{})
+	defer close(stop)
+	go informer.Run(stop)
+	if !cache.WaitForCacheSync(ctx.Done(), informer.HasSynced) {
+		return nil, ctx.Err()
+	}
+
+	base := NewGPUJob(load.NamePrefix, load.Image, load.GPUCount)
+	base.Spec.Template.Labels = map[string]string{LoadJobLabel: ""}
+	template, err := NewJobTemplate(base)
+	if err != nil {
+		return nil, err
+	}
+
+	limit := rate.Inf
+	if load.Rate > 0 {
+		limit = rate.Limit(load.Rate)
+	}
+	limiter := rate.NewLimiter(limit, 1)
+	jobs := cs.BatchV1().Jobs(namespace)
+	for i := 0; i < load.Jobs; i++ {
+		if err := limiter.Wait(ctx); err != nil {
+			return nil, err
+		}
+		job := template.NewIndexed(i)
+		name := job.Name
+		job.Spec.Template.Labels[LoadJobLabel] = name
+
+		// Register the job before creating it, pod events may arrive
+		// before Create returns.
+		mu.Lock()
+		timelines[name] = &podTimeline{created: time.Now()}
+		mu.Unlock()
+		if load.Pods {
+			pod := &corev1.Pod{ObjectMeta: job.Spec.Template.ObjectMeta, Spec: job.Spec.Template.Spec}
+			pod.Name = name
+			pod.Spec.NodeName = load.Nodes[i%len(load.Nodes)]
+			if _, err := pods.Create(ctx, pod, metav1.CreateOptions{}); err != nil {
+				return nil, fmt.Errorf("error creating pod %s: %w", name, err)
+			}
+			continue
+		}
+		if _, err := jobs.Create(ctx, job, metav1.CreateOptions{}); err != nil {
+			return nil, fmt.Errorf("error creating job %s: %w", name, err)
+		}
+	}
+
+	select {
+	case <-finished:
+	case <-ctx.Done():
+		err = ctx.Err()
+	}
+
+	mu.Lock()
+	defer mu.Unlock()
+	return summarizeLoad(timelines), err
+}
+
+func podScheduled(pod *corev1.Pod) bool {
+	if pod.Spec.NodeName != "" {
+		return true
+	}
+	for _, c := range pod.Status.Conditions {
+		if c.Type == corev1.PodScheduled {
+			return c.Status == corev1.ConditionTrue
+		}
+	}
+	return false
+}
+
+// summarizeLoad computes the latency percentiles of the observed pods. A
+// transition that was not observed, e.g. a pod that finished between two
+// events, is attributed to the next observed one.
+func summarizeLoad(timelines map[string]*podTimeline) *GPUJobLoadReport {
+	report := &GPUJobLoadReport{Jobs: len(timelines)}
+	var toScheduled, toRunning, toCompleted []time.Duration
+	for _, t := range timelines {
+		scheduled, running := t.scheduled, t.running
+		if running.IsZero() {
+			running = t.finished
+		}
+		if scheduled.IsZero() {
+			scheduled = running
+		}
+		if !scheduled.IsZero() {
+			toScheduled = append(toScheduled, scheduled.Sub(t.created))
+		}
+		if !running.IsZero() {
+			toRunning = append(toRunning, running.Sub(scheduled))
+		}
+		if t.finished.IsZero() {
+			continue
+		}
+		if t.failed {
+			report.Failed++
+			continue
+		}
+		report.Completed++
+		toCompleted = append(toCompleted, t.finished.Sub(running))
+	}
+	report.CreateToScheduled = summarizeLatencies(toScheduled)
+	report.ScheduledToRunning = summarizeLatencies(toRunning)
+	report.RunningToCompleted = summarizeLatencies(toCompleted)
+	return report
+}
+
+func summarizeLatencies(ds []time.Duration) LatencySummary {
+	if len(ds) == 0 {
+		return LatencySummary{}
+	}
+	sort.Slice(ds, func(i, j int) bool { return ds[i] < ds[j] })
+	// nearest-rank percentile
+	at := func(p float64) float64 {
+		idx := int(math.Ceil(p*float64(len(ds)))) - 1
+		if idx < 0 {
+			idx = 0
+		}
+		return ds[idx].Seconds()
+	}
+	return LatencySummary{
+		Count: len(ds),
+		P50:   at(0.50),
+		P90:   at(0.90),
+		P99:   at(0.99),
+		Max:   ds[len(ds)-1].Seconds(),
+	}
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"testing"
+	"time"
+)
+
+func TestRunGPUJobLoadSimulated(t *testing.T) {
+	server := newFakeAPIServer(t)
+	cs := server.clientset(t)
+	ctx, cancel := context.WithTimeout(context.Background(), 30*time.Second)
+	defer cancel()
+
+	nodes, err := CreateGPUFleet(ctx, cs, nil, GPUFleet{Nodes: 4})
+	if err != nil {
+		t.Fatal(err)
+	}
+	simCtx, stopSim := context.WithCancel(ctx)
+	defer stopSim()
+	go NewPodSimulator(cs, nodes, 10*time.Millisecond).Run(simCtx)
+
+	report, err := RunGPUJobLoad(ctx, cs, "e2e-load", GPUJobLoad{
+		Jobs:     20,
+		GPUCount: 1,
+		Pods:     true,
+		Nodes:    nodes,
+	})
+	if err != nil {
+		t.Fatal(err)
+	}
+	if report.Jobs != 20 || report.Completed != 20 || report.Failed != 0 {
+		t.Errorf("got %d jobs, %d completed, %d failed; want 20 completed", report.Jobs, report.Completed, report.Failed)
+	}
+	if report.CreateToScheduled.Count != 20 || report.RunningToCompleted.Count != 20 {
+		t.Errorf("incomplete latencies: %+v", report)
+	}
+	if n := server.count("POST jobs"); n != 0 {
+		t.Errorf("created %d jobs, want pods only", n)
+	}
+}
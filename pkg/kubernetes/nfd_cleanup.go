@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"fmt"
+	"time"
+
+	"golang.org/x/sync/errgroup"
+	"k8s.io/apimachinery/pkg/api/errors"
+	"k8s.io/apimachinery/pkg/api/meta"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	k8sruntime "k8s.io/apimachinery/pkg/runtime"
+	"k8s.io/apimachinery/pkg/types"
+	"k8s.io/apimachinery/pkg/watch"
+	"k8s.io/client-go/tools/cache"
+	watchtools "k8s.io/client-go/tools/watch"
+	nfdv1alpha1 "sigs.k8s.io/node-feature-discovery/pkg/apis/nfd/v1alpha1"
+	nfdclient "sigs.k8s.io/node-feature-discovery/pkg/generated/clientset/versioned"
+)
+
+// nfdCleanupTimeout bounds the wait for deleted NFD objects to disappear.
+const nfdCleanupTimeout = 2 * time.Minute
+
+// collectionClient is the subset of a typed client used to empty a collection.
+type collectionClient[L k8sruntime.Object] interface {
+	List(ctx context.Context, opts metav1.ListOptions) (L, error)
+	Watch(ctx context.Context, opts metav1.ListOptions) (watch.Interface, error)
+	Delete(ctx context.Context, name string, opts metav1.DeleteOptions) error
+	DeleteCollection(ctx context.Context, opts metav1.DeleteOptions, listOpts metav1.ListOptions) error
+}
+
+// DeleteNFDObjects deletes the NodeFeatureRules of the cluster and the
+// NodeFeatures of namespace matching opts.LabelSelector, and waits until they
+// are gone. Unlike CleanupNFDObjects it returns errors instead of failing the
+// spec, so it can be called from any goroutine and outside of Ginkgo.
+func DeleteNFDObjects(ctx context.Context, cli nfdclient.Interface, namespace string, opts CleanupOptions) error {
+	g, ctx := errgroup.WithContext(ctx)
+	g.Go(func() error {
+		err := deleteCollection[*nfdv1alpha1.NodeFeatureRuleList](ctx, cli.NfdV1alpha1().NodeFeatureRules(), &nfdv1alpha1.NodeFeatureRule{}, opts.LabelSelector, opts.parallelism())
+		if err != nil {
+			return fmt.Errorf("error deleting NodeFeatureRule objects: %w", err)
+		}
+		return nil
+	})
+	g.Go(func() error {
+		err := deleteCollection[*nfdv1alpha1.NodeFeatureList](ctx, cli.NfdV1alpha1().NodeFeatures(namespace), &nfdv1alpha1.NodeFeature{}, opts.LabelSelector, opts.parallelism())
+		if err != nil {
+			return fmt.Errorf("error deleting NodeFeature objects from namespace %s: %w", namespace, err)
+		}
+		return nil
+	})
+	return g.Wait()
+}
+
+// deleteCollection deletes the objects matching labelSelector with a single
+// DeleteCollection call, falling back to concurrent deletes if the server
+// does not support it, and then watches until they are gone. Only the objects
+// listed before the delete are waited for: a running nfd-worker recreates its
+// NodeFeature right away, and the new object must not block the cleanup. A
+// missing resource type is not an error.
+func deleteCollection[L k8sruntime.Object](ctx context.Context, c collectionClient[L], objType k8sruntime.Object, labelSelector string, parallelism int) error {
+	listOpts := metav1.ListOptions{LabelSelector: labelSelector}
+	list, err := c.List(ctx, listOpts)
+	if errors.IsNotFound(err) {
+		return nil
+	}
+	if err != nil {
+		return err
+	}
+	items, err := meta.ExtractList(list)
+	if err != nil {
+		return err
+	}
+	if len(items) == 0 {
+		return nil
+	}
+	pending := make(map[types.UID]bool, len(items))
+	for _, item := range items {
+		obj, err := meta.Accessor(item)
+		if err != nil {
+			return err
+		}
+		pending[obj.GetUID()] = true
+	}
+
+	err = c.DeleteCollection(ctx, metav1.DeleteOptions{}, listOpts)
+	switch {
+	case err == nil:
+	case errors.IsNotFound(err):
+		return nil
+	case errors.IsMethodNotSupported(err):
+		if err := deleteEach[L](ctx, c, items, parallelism); err != nil {
+			return err
+		}
+	default:
+		return err
+	}
+
+	ctx, cancel := context.WithTimeout(ctx, nfdCleanupTimeout)
+	defer cancel()
+	return waitDeleted[L](ctx, c, objType, listOpts, pending)
+}
+
+// deleteEach deletes up to parallelism of the given objects at once.
+func deleteEach[L k8sruntime.Object](ctx context.Context, c collectionClient[L], items []k8sruntime.Object, parallelism int) error {
+	g, ctx := errgroup.WithContext(ctx)
+	g.SetLimit(parallelism)
+	for _, item := range items {
+		obj, err := meta.Accessor(item)
+		if err != nil {
+			return err
+		}
+		name := obj.GetName()
+		g.Go(func() error {
+			if err := c.Delete(ctx, name, metav1.DeleteOptions{}); err != nil && !errors.IsNotFound(err) {
+				return err
+			}
+			return nil
+		})
+	}
+	return g.Wait()
+}
+
+// waitDeleted watches the objects matching listOpts until none of the objects
+// with the pending UIDs is left. Objects created in the meantime are ignored.
+func waitDeleted[L k8sruntime.Object](ctx context.Context, c collectionClient[L], objType k8sruntime.Object, listOpts metav1.ListOptions, pending map[types.UID]bool) error {
+	lw := &cache.ListWatch{
+		ListFunc: func(options metav1.ListOptions) (k8sruntime.Object, error) {
+			options.LabelSelector = listOpts.LabelSelector
+			return c.List(ctx, options)
+		},
+		WatchFunc: func(options metav1.ListOptions) (watch.Interface, error) {
+			options.LabelSelector = listOpts.LabelSelector
+			return c.Watch(ctx, options)
+		},
+	}
+
+	precondition := func(store cache.Store) (bool, error) {
+		present := map[types.UID]bool{}
+		for _, item := range store.List() {
+			if obj, err := meta.Accessor(item); err == nil {
+				present[obj.GetUID()] = true
+			}
+		}
+		for uid := range pending {
+			if !present[uid] {
+				delete(pending, uid)
+			}
+		}
+		return len(pending) == 0, nil
+	}
+	condition := func(event watch.Event) (bool, error) {
+		if event.Type == watch.Deleted {
+			if obj, err := meta.Accessor(event.Object); err == nil {
+				delete(pending, obj.GetUID())
+			}
+		}
+		return len(pending) == 0, nil
+	}
+	_, err := watchtools.UntilWithSync(ctx, lw, objType, precondition, condition)
+	return err
+}
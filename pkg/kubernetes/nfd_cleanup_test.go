@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"testing"
+	"time"
+
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/watch"
+)
+
+// TestDeleteNFDObjectsRecreated checks that NodeFeatures recreated by a
+// running nfd-worker do not block the cleanup.
+func TestDeleteNFDObjectsRecreated(t *testing.T) {
+	server := newFakeAPIServer(t)
+	nfd := server.nfdClient(t)
+	ctx, cancel := context.WithTimeout(context.Background(), 30*time.Second)
+	defer cancel()
+
+	fleet := GPUFleet{Nodes: 5, NFD: true, NFDNamespace: "nfd"}
+	for i := 0; i < fleet.Nodes; i++ {
+		server.add("nfd.k8s-sigs.io/v1alpha1", "nodefeatures", fleet.NewNodeFeature(i))
+	}
+
+	// Stand in for nfd-worker: recreate every deleted NodeFeature.
+	w, err := nfd.NfdV1alpha1().NodeFeatures("nfd").Watch(ctx, metav1.ListOptions{ResourceVersion: "0"})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer w.Stop()
+	go func() {
+		for event := range w.ResultChan() {
+			if event.Type != watch.Deleted {
+				continue
+			}
+			for i := 0; i < fleet.Nodes; i++ {
+				nf := fleet.NewNodeFeature(i)
+				if nf.Name == event.Object.(metav1.Object).GetName() {
+					nfd.NfdV1alpha1().NodeFeatures("nfd").Create(ctx, nf, metav1.CreateOptions{})
+				}
+			}
+		}
+	}()
+
+	start := time.Now()
+	if err := DeleteNFDObjects(ctx, nfd, "nfd", CleanupOptions{}); err != nil {
+		t.Fatal(err)
+	}
+	if elapsed := time.Since(start); elapsed > 10*time.Second {
+		t.Errorf("cleanup took %v", elapsed)
+	}
+	if got := server.count("DELETE nodefeatures"); got != 1 {
+		t.Errorf("got %d deletes, want a single DeleteCollection", got)
+	}
+}
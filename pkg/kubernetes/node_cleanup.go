@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"encoding/json"
+	"fmt"
+	"runtime"
+	"slices"
+	"strings"
+	"time"
+
+	"golang.org/x/sync/errgroup"
+	corev1 "k8s.io/api/core/v1"
+	"k8s.io/apimachinery/pkg/api/errors"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/labels"
+	"k8s.io/apimachinery/pkg/types"
+	"k8s.io/apimachinery/pkg/util/wait"
+	clientset "k8s.io/client-go/kubernetes"
+	nfdv1alpha1 "sigs.k8s.io/node-feature-discovery/pkg/apis/nfd/v1alpha1"
+)
+
+// nodeCleanupBackoff paces the retries of a node cleanup after conflicts or
+// throttling.
+var nodeCleanupBackoff = wait.Backoff{
+	Duration: 50 * time.Millisecond,
+	Factor:   2,
+	Jitter:   0.5,
+	Steps:    6,
+	Cap:      2 * time.Second,
+}
+
+// CleanupOptions configures the error-returning cleanup helpers.
+type CleanupOptions struct {
+	// Parallelism bounds the number of objects cleaned up at once. Zero uses
+	// GOMAXPROCS.
+	Parallelism int
+	// LabelSelector limits the NFD objects deleted by DeleteNFDObjects.
+	LabelSelector string
+}
+
+func (o CleanupOptions) parallelism() int {
+	if o.Parallelism <= 0 {
+		return runtime.GOMAXPROCS(0)
+	}
+	return o.Parallelism
+}
+
+// CleanupNodes removes the NFD labels, annotations, taints and extended
+// resources from all nodes. Unlike CleanupNode it returns errors instead of
+// failing the spec, so it can be called from any goroutine and outside of
+// Ginkgo, e.g. by a janitor cleaning several clusters at once.
+func CleanupNodes(ctx context.Context, cs clientset.Interface, opts CleanupOptions) error {
+	nodeList, err := cs.CoreV1().Nodes().List(ctx, metav1.ListOptions{})
+	if err != nil {
+		return fmt.Errorf("error listing nodes: %w", err)
+	}
+	nodes := make([]*corev1.Node, len(nodeList.Items))
+	for i := range nodeList.Items {
+		nodes[i] = &nodeList.Items[i]
+	}
+	return cleanupListedNodes(ctx, cs, nodes, opts.parallelism())
+}
+
+// CleanupNodesFromLister is like CleanupNodes but starts from the nodes of a
+// local cache, so that the cleanup costs no reads unless a write conflicts.
+func CleanupNodesFromLister(ctx context.Context, cs clientset.Interface, lister NodeLister, opts CleanupOptions) error {
+	nodes, err := lister.List(labels.Everything())
+	if err != nil {
+		return fmt.Errorf("error listing nodes: %w", err)
+	}
+	return cleanupListedNodes(ctx, cs, nodes, opts.parallelism())
+}
+
+// cleanupListedNodes patches the given nodes as they were listed, and only
+// reads a node again after its patch conflicted with a newer version. The
+// nodes are not modified, so they may be shared with a cache.
+func cleanupListedNodes(ctx context.Context, cs clientset.Interface, nodes []*corev1.Node, parallelism int) error {
+	g, ctx := errgroup.WithContext(ctx)
+	g.SetLimit(parallelism)
+	for _, node := range nodes {
+		node := node
+		g.Go(func() error {
+			current := node
+			err := retryOnError(ctx, nodeCleanupBackoff, retriableWriteError, func() error {
+				if current == nil {
+					var err error
+					current, err = cs.CoreV1().Nodes().Get(ctx, node.Name, metav1.GetOptions{})
+					if errors.IsNotFound(err) {
+						return nil
+					}
+					if err != nil {
+						current = nil
+						return err
+					}
+				}
+				err := patchNodeCleanup(ctx, cs, current)
+				if errors.IsConflict(err) {
+					current = nil
+				}
+				return err
+			})
+			if err != nil {
+				return fmt.Errorf("error cleaning up node %s: %w", node.Name, err)
+			}
+			return nil
+		})
+	}
+	return g.Wait()
+}
+
+// patchNodeCleanup sends the patches computed by nodeCleanupPatches. The
+// metadata patch may be guarded by the resourceVersion of node, so it goes
+// first; the unguarded status patch would bump that version.
+func patchNodeCleanup(ctx context.Context, cs clientset.Interface, node *corev1.Node) error {
+	metadata, status, err := nodeCleanupPatches(node)
+	if err != nil {
+		return err
+	}
+	if metadata != nil {
+		if _, err := cs.CoreV1().Nodes().Patch(ctx, node.Name, types.MergePatchType, metadata, metav1.PatchOptions{}); err != nil {
+			return err
+		}
+	}
+	if status != nil {
+		if _, err := cs.CoreV1().Nodes().Patch(ctx, node.Name, types.MergePatchType, status, metav1.PatchOptions{}, "status"); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// nodeCleanupPatches computes the JSON merge patches that remove the NFD
+// labels, annotations and taints, and the NFD extended resources from the
+// status of node. A nil patch means there is nothing to remove.
+//
+// Labels, annotations and resources are removed by key and can be applied
+// to any version of the node. Taints are a list and can only be replaced as a
+// whole, so that patch is guarded by the resourceVersion of node.
+func nodeCleanupPatches(node *corev1.Node) ([]byte, []byte, error) {
+	// Gather info about all NFD-managed node assets outside the default prefix
+	nfdLabels := map[string]struct{}{}
+	for _, name := range strings.Split(node.Annotations[nfdv1alpha1.FeatureLabelsAnnotation], ",") {
+		if strings.Contains(name, "/") {
+			nfdLabels[name] = struct{}{}
+		}
+	}
+	nfdERs := map[string]struct{}{}
+	for _, name := range strings.Split(node.Annotations[nfdv1alpha1.ExtendedResourceAnnotation], ",") {
+		if strings.Contains(name, "/") {
+			nfdERs[name] = struct{}{}
+		}
+	}
+
+	metadata := map[string]interface{}{}
+	labels := map[string]interface{}{}
+	for key := range node.Labels {
+		if _, ok := nfdLabels[key]; ok || strings.HasPrefix(key, nfdv1alpha1.FeatureLabelNs) {
+			labels[key] = nil
+		}
+	}
+	if len(labels) > 0 {
+		metadata["labels"] = labels
+	}
+	annotations := map[string]interface{}{}
+	for key := range node.Annotations {
+		if strings.HasPrefix(key, nfdv1alpha1.AnnotationNs) {
+			annotations[key] = nil
+		}
+	}
+	if len(annotations) > 0 {
+		metadata["annotations"] = annotations
+	}
+
+	patch := map[string]interface{}{}
+	isNFDTaint := func(t corev1.Taint) bool { return strings.HasPrefix(t.Key, nfdv1alpha1.TaintNs) }
+	if slices.ContainsFunc(node.Spec.Taints, isNFDTaint) {
+		// Filter a copy, node may be shared with a cache.
+		taints, _ := DeleteTaintsWithKeyPrefix(slices.Clone(node.Spec.Taints), nfdv1alpha1.TaintNs)
+		metadata["resourceVersion"] = node.ResourceVersion
+		patch["spec"] = map[string]interface{}{"taints": taints}
+	}
+	if len(metadata) > 0 {
+		patch["metadata"] = metadata
+	}
+
+	resources := map[string]interface{}{}
+	for key := range node.Status.Capacity {
+		// We check for FeatureLabelNs as -resource-labels can create ERs there
+		if _, ok := nfdERs[string(key)]; ok || strings.HasPrefix(string(key), nfdv1alpha1.FeatureLabelNs) {
+			resources[string(key)] = nil
+		}
+	}
+
+	var metadataPatch, statusPatch []byte
+	var err error
+	if len(patch) > 0 {
+		if metadataPatch, err = json.Marshal(patch); err != nil {
+			return nil, nil, err
+		}
+	}
+	if len(resources) > 0 {
+		status := map[string]interface{}{
+			"status": map[string]interface{}{
+				"capacity":    resources,
+				"allocatable": resources,
+			},
+		}
+		if statusPatch, err = json.Marshal(status); err != nil {
+			return nil, nil, err
+		}
+	}
+	return metadataPatch, statusPatch, nil
+}
+
+// retriableWriteError reports whether a write may succeed when retried.
+func retriableWriteError(err error) bool {
+	return errors.IsConflict(err) || errors.IsServerTimeout(err) ||
+		errors.IsTimeout(err) || errors.IsTooManyRequests(err)
+}
+
+// retryOnError calls fn until it succeeds, fails with an error that is not
+// retriable, or backoff is exhausted, and returns the last error of fn.
+func retryOnError(ctx context.Context, backoff wait.Backoff, retriable func(error) bool, fn func() error) error {
+	var lastErr error
+	err := wait.ExponentialBackoffWithContext(ctx, backoff, func(context.Context) (bool, error) {
+		lastErr = fn()
+		switch {
+		case lastErr == nil:
+			return true, nil
+		case retriable(lastErr):
+			return false, nil
+		default:
+			return false, lastErr
+		}
+	})
+	if wait.Interrupted(err) && lastErr != nil {
+		return lastErr
+	}
+	return err
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"fmt"
+	"strings"
+	"testing"
+
+	corev1 "k8s.io/api/core/v1"
+	"k8s.io/apimachinery/pkg/api/resource"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	nfdv1alpha1 "sigs.k8s.io/node-feature-discovery/pkg/apis/nfd/v1alpha1"
+)
+
+// nfdNode returns a fleet worker node carrying NFD labels, annotations, an
+// NFD taint and an NFD extended resource, i.e. everything CleanupNodes
+// removes.
+func nfdNode(i int) *corev1.Node {
+	node := GPUFleet{NFD: true}.NewNode(i)
+	er := corev1.ResourceName(nfdv1alpha1.FeatureLabelNs + "/gpu-slots")
+	node.Annotations[nfdv1alpha1.ExtendedResourceAnnotation] = string(er)
+	node.Status.Capacity[er] = resource.MustParse("4")
+	node.Status.Allocatable[er] = resource.MustParse("4")
+	node.Spec.Taints = []corev1.Taint{
+		{Key: nfdv1alpha1.TaintNs + "/gpu", Effect: corev1.TaintEffectNoSchedule},
+		{Key: "example.com/keep", Effect: corev1.TaintEffectNoSchedule},
+	}
+	return node
+}
+
+func seedNFDNodes(server *fakeAPIServer, n int) {
+	for i := 0; i < n; i++ {
+		server.add("v1", "nodes", nfdNode(i))
+	}
+}
+
+func TestCleanupNodes(t *testing.T) {
+	server := newFakeAPIServer(t)
+	cs := server.clientset(t)
+	ctx := context.Background()
+	const n = 20
+	seedNFDNodes(server, n)
+
+	if err := CleanupNodes(ctx, cs, CleanupOptions{}); err != nil {
+		t.Fatal(err)
+	}
+	// One list and one metadata and status patch per node, without
+	// conflicts and re-reads.
+	if got := server.count("GET nodes"); got != 1 {
+		t.Errorf("got %d node reads, want 1 list", got)
+	}
+	if got := server.count("PATCH nodes") + server.count("PATCH nodes/status"); got != 2*n {
+		t.Errorf("got %d node patches, want %d", got, 2*n)
+	}
+
+	nodes, err := cs.CoreV1().Nodes().List(ctx, metav1.ListOptions{})
+	if err != nil {
+		t.Fatal(err)
+	}
+	for _, node := range nodes.Items {
+		for key := range node.Labels {
+			if strings.HasPrefix(key, nfdv1alpha1.FeatureLabelNs) {
+				t.Errorf("node %s kept label %s", node.Name, key)
+			}
+		}
+		for key := range node.Annotations {
+			if strings.HasPrefix(key, nfdv1alpha1.AnnotationNs) {
+				t.Errorf("node %s kept annotation %s", node.Name, key)
+			}
+		}
+		if len(node.Spec.Taints) != 1 || node.Spec.Taints[0].Key != "example.com/keep" {
+			t.Errorf("node %s has taints %v, want only example.com/keep", node.Name, node.Spec.Taints)
+		}
+		for key := range node.Status.Capacity {
+			if strings.HasPrefix(string(key), nfdv1alpha1.FeatureLabelNs) {
+				t.Errorf("node %s kept extended resource %s", node.Name, key)
+			}
+		}
+	}
+}
+
+// BenchmarkCleanupNodes measures a cleanup of NFD nodes through a clientset,
+// and reports the API requests it costs per node.
+func BenchmarkCleanupNodes(b *testing.B) {
+	for _, n := range []int{100, 1000} {
+		b.Run(fmt.Sprintf("nodes=%d", n), func(b *testing.B) {
+			server := newFakeAPIServer(b)
+			cs := server.clientset(b)
+			var requests int
+			for i := 0; i < b.N; i++ {
+				b.StopTimer()
+				seedNFDNodes(server, n)
+				server.resetCounts()
+				b.StartTimer()
+
+				if err := CleanupNodes(context.Background(), cs, CleanupOptions{Parallelism: 16}); err != nil {
+					b.Fatal(err)
+				}
+
+				b.StopTimer()
+				requests += server.count("GET nodes") + server.count("PATCH nodes") + server.count("PATCH nodes/status")
+				b.StartTimer()
+			}
+			b.ReportMetric(float64(requests)/float64(b.N*n), "requests/node")
+		})
+	}
+}
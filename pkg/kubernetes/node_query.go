@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"fmt"
+	"strconv"
+	"sync"
+	"time"
+
+	corev1 "k8s.io/api/core/v1"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	clientset "k8s.io/client-go/kubernetes"
+)
+
+var (
+	nodeCachesMu sync.Mutex
+	nodeCaches   = map[nodeCacheKey]*NodeCache{}
+)
+
+type nodeCacheKey struct {
+	cluster string
+	ttl     time.Duration
+}
+
+// nodeMetadataPageSize bounds the size of every list response of
+// ListNodeMetadata.
+const nodeMetadataPageSize = 500
+
+// NodeCache serves repeated node queries against one cluster from memory.
+// Results are kept for a fixed TTL per label selector. Every caller gets its
+// own copy of the nodes.
+type NodeCache struct {
+	cs  clientset.Interface
+	ttl time.Duration
+
+	mu      sync.Mutex
+	entries map[string]nodeCacheEntry
+}
+
+type nodeCacheEntry struct {
+	nodes   []corev1.Node
+	expires time.Time
+}
+
+// NewNodeCache returns a NodeCache reading through cs.
+func NewNodeCache(cs clientset.Interface, ttl time.Duration) *NodeCache {
+	return &NodeCache{cs: cs, ttl: ttl, entries: map[string]nodeCacheEntry{}}
+}
+
+// NodeCacheFor returns the process-wide NodeCache of the given cluster, e.g.
+// its API server host, and ttl, creating it with cs on first use. Callers
+// asking for different TTLs get different caches.
+func NodeCacheFor(cluster string, cs clientset.Interface, ttl time.Duration) *NodeCache {
+	nodeCachesMu.Lock()
+	defer nodeCachesMu.Unlock()
+	key := nodeCacheKey{cluster: cluster, ttl: ttl}
+	c, ok := nodeCaches[key]
+	if !ok {
+		c = NewNodeCache(cs, ttl)
+		nodeCaches[key] = c
+	}
+	return c
+}
+
+// NonControlPlaneNodes is like GetNonControlPlaneNodes, but only lists the
+// nodes matching labelSelector and serves repeated calls from the cache.
+// The list is served from the API server watch cache, so it may lag behind
+// the latest writes by a moment.
+func (c *NodeCache) NonControlPlaneNodes(ctx context.Context, labelSelector string) ([]corev1.Node, error) {
+	c.mu.Lock()
+	entry, ok := c.entries[labelSelector]
+	c.mu.Unlock()
+	if ok && time.Now().Before(entry.expires) {
+		return deepCopyNodes(entry.nodes), nil
+	}
+
+	nodeList, err := c.cs.CoreV1().Nodes().List(ctx, metav1.ListOptions{
+		LabelSelector:   labelSelector,
+		ResourceVersion: "0",
+	})
+	if err != nil {
+		return nil, err
+	}
+	nodes, err := nonControlPlaneNodes(nodeList.Items)
+	if err != nil {
+		return nil, err
+	}
+
+	c.mu.Lock()
+	c.entries[labelSelector] = nodeCacheEntry{nodes: nodes, expires: time.Now().Add(c.ttl)}
+	c.mu.Unlock()
+	return deepCopyNodes(nodes), nil
+}
+
+func deepCopyNodes(nodes []corev1.Node) []corev1.Node {
+	out := make([]corev1.Node, len(nodes))
+	for i := range nodes {
+		nodes[i].DeepCopyInto(&out[i])
+	}
+	return out
+}
+
+// Invalidate drops all cached results, e.g. after a test changed node labels
+// or taints.
+func (c *NodeCache) Invalidate() {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	c.entries = map[string]nodeCacheEntry{}
+}
+
+// ListNodeMetadata returns the metadata of the nodes matching labelSelector.
+// The server projects the list into a Table without node specs and status,
+// which cuts the response size by orders of magnitude on large clusters.
+// Taints are part of the spec, so this can not filter control-plane nodes;
+// use it when a label selector identifies the nodes of interest. The nodes
+// are listed in pages of nodeMetadataPageSize.
+func ListNodeMetadata(ctx context.Context, cs clientset.Interface, labelSelector string) ([]metav1.PartialObjectMetadata, error) {
+	rc, err := RESTClient(cs)
+	if err != nil {
+		return nil, err
+	}
+	var nodes []metav1.PartialObjectMetadata
+	continueToken := ""
+	for {
+		req := rc.Get().
+			Resource("nodes").
+			Param("includeObject", string(metav1.IncludeMetadata)).
+			Param("limit", strconv.Itoa(nodeMetadataPageSize)).
+			SetHeader("Accept", TableMetadataAccept)
+		if labelSelector != "" {
+			req = req.Param("labelSelector", labelSelector)
+		}
+		if continueToken != "" {
+			req = req.Param("continue", continueToken)
+		}
+		data, err := req.DoRaw(ctx)
+		if err != nil {
+			return nil, err
+		}
+		var page []metav1.PartialObjectMetadata
+		page, continueToken, err = DecodeMetadataTable(data)
+		if err != nil {
+			return nil, fmt.Errorf("error listing node metadata: %w", err)
+		}
+		nodes = append(nodes, page...)
+		if continueToken == "" {
+			return nodes, nil
+		}
+	}
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"testing"
+	"time"
+)
+
+func seedFleet(server *fakeAPIServer, fleet GPUFleet) {
+	for i := 0; i < fleet.ControlPlaneNodes+fleet.Nodes; i++ {
+		server.add("v1", "nodes", fleet.NewNode(i))
+	}
+}
+
+func TestNodeCacheReturnsCopies(t *testing.T) {
+	server := newFakeAPIServer(t)
+	seedFleet(server, GPUFleet{Nodes: 3, ControlPlaneNodes: 1})
+	cache := NewNodeCache(server.clientset(t), time.Minute)
+	ctx := context.Background()
+
+	first, err := cache.NonControlPlaneNodes(ctx, "")
+	if err != nil {
+		t.Fatal(err)
+	}
+	first[0].Name = "modified"
+	first[0].Labels["modified"] = "true"
+
+	second, err := cache.NonControlPlaneNodes(ctx, "")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if len(second) != 3 {
+		t.Fatalf("got %d nodes, want 3", len(second))
+	}
+	if second[0].Name == "modified" || second[0].Labels["modified"] != "" {
+		t.Error("modifying a result changed the cache")
+	}
+	if got := server.count("GET nodes"); got != 1 {
+		t.Errorf("got %d node lists, want 1", got)
+	}
+}
+
+func TestNodeCacheForTTL(t *testing.T) {
+	server := newFakeAPIServer(t)
+	cs := server.clientset(t)
+	short := NodeCacheFor(t.Name(), cs, time.Second)
+	long := NodeCacheFor(t.Name(), cs, time.Hour)
+	if short == long || short.ttl != time.Second || long.ttl != time.Hour {
+		t.Error("caches with different TTLs are shared")
+	}
+	if NodeCacheFor(t.Name(), cs, time.Second) != short {
+		t.Error("cache with the same cluster and TTL is not shared")
+	}
+}
+
+// BenchmarkNodeQueries compares the response bytes and latency of the node
+// queries on a 1,000-node cluster.
+func BenchmarkNodeQueries(b *testing.B) {
+	server := newFakeAPIServer(b)
+	seedFleet(server, GPUFleet{Nodes: 1000, ControlPlaneNodes: 3, NFD: true})
+	cs := server.clientset(b)
+	ctx := context.Background()
+	const selector = "nvidia.com/gpu.present=true"
+
+	queries := []struct {
+		name  string
+		query func() error
+	}{
+		{"GetNonControlPlaneNodes", func() error {
+			_, err := GetNonControlPlaneNodes(ctx, cs)
+			return err
+		}},
+		{"NodeCache/miss", func() error {
+			_, err := NewNodeCache(cs, time.Minute).NonControlPlaneNodes(ctx, selector)
+			return err
+		}},
+		{"NodeCache/hit", func() func() error {
+			cache := NewNodeCache(cs, time.Hour)
+			return func() error {
+				_, err := cache.NonControlPlaneNodes(ctx, selector)
+				return err
+			}
+		}()},
+		{"ListNodeMetadata", func() error {
+			_, err := ListNodeMetadata(ctx, cs, selector)
+			return err
+		}},
+	}
+	for _, q := range queries {
+		b.Run(q.name, func(b *testing.B) {
+			server.resetCounts()
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				if err := q.query(); err != nil {
+					b.Fatal(err)
+				}
+			}
+			b.ReportMetric(float64(server.ResponseBytes())/float64(b.N), "resp-bytes/op")
+		})
+	}
+}
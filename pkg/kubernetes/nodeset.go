@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	corev1 "k8s.io/api/core/v1"
+)
+
+// NodeSet indexes a list of nodes by name, label, taint key and allocatable
+// extended resource. It is built once and read-only afterwards; the returned
+// nodes point into the set and must not be modified.
+type NodeSet struct {
+	nodes      []corev1.Node
+	byName     map[string]int
+	byLabelKey map[string][]int
+	byLabel    map[string]map[string][]int
+	byTaintKey map[string][]int
+	byResource map[corev1.ResourceName][]int
+}
+
+// NewNodeSet indexes the given nodes. Lookups return nodes in list order.
+func NewNodeSet(nodes []corev1.Node) *NodeSet {
+	s := &NodeSet{
+		nodes:      nodes,
+		byName:     make(map[string]int, len(nodes)),
+		byLabelKey: map[string][]int{},
+		byLabel:    map[string]map[string][]int{},
+		byTaintKey: map[string][]int{},
+		byResource: map[corev1.ResourceName][]int{},
+	}
+	for i := range nodes {
+		node := &nodes[i]
+		s.byName[node.Name] = i
+		for key, value := range node.Labels {
+			s.byLabelKey[key] = append(s.byLabelKey[key], i)
+			values, ok := s.byLabel[key]
+			if !ok {
+				values = map[string][]int{}
+				s.byLabel[key] = values
+			}
+			values[value] = append(values[value], i)
+		}
+		for _, taint := range node.Spec.Taints {
+			taints := s.byTaintKey[taint.Key]
+			// A key may be present once per effect.
+			if len(taints) == 0 || taints[len(taints)-1] != i {
+				s.byTaintKey[taint.Key] = append(taints, i)
+			}
+		}
+		for name, quantity := range node.Status.Allocatable {
+			if !quantity.IsZero() {
+				s.byResource[name] = append(s.byResource[name], i)
+			}
+		}
+	}
+	return s
+}
+
+// Len returns the number of nodes in the set.
+func (s *NodeSet) Len() int {
+	return len(s.nodes)
+}
+
+// Nodes returns all nodes of the set.
+func (s *NodeSet) Nodes() []corev1.Node {
+	return s.nodes
+}
+
+// Get returns the named node and whether it is part of the set.
+func (s *NodeSet) Get(name string) (*corev1.Node, bool) {
+	i, ok := s.byName[name]
+	if !ok {
+		return nil, false
+	}
+	return &s.nodes[i], true
+}
+
+// WithLabelKey returns the nodes that have the label key, with any value.
+func (s *NodeSet) WithLabelKey(key string) []*corev1.Node {
+	return s.resolve(s.byLabelKey[key])
+}
+
+// WithLabel returns the nodes whose label key is set to value.
+func (s *NodeSet) WithLabel(key, value string) []*corev1.Node {
+	return s.resolve(s.byLabel[key][value])
+}
+
+// WithTaintKey returns the nodes that have a taint with the given key, with
+// any value and effect.
+func (s *NodeSet) WithTaintKey(key string) []*corev1.Node {
+	return s.resolve(s.byTaintKey[key])
+}
+
+// WithAllocatable returns the nodes with a non-zero allocatable amount of
+// the given resource, e.g. nvidia.com/gpu.
+func (s *NodeSet) WithAllocatable(resource corev1.ResourceName) []*corev1.Node {
+	return s.resolve(s.byResource[resource])
+}
+
+func (s *NodeSet) resolve(indexes []int) []*corev1.Node {
+	if len(indexes) == 0 {
+		return nil
+	}
+	out := make([]*corev1.Node, len(indexes))
+	for i, idx := range indexes {
+		out[i] = &s.nodes[idx]
+	}
+	return out
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"testing"
+
+	corev1 "k8s.io/api/core/v1"
+)
+
+// benchFleetNodes returns n GPU worker nodes, every tenth of them without
+// GPUs, and the name of a node in the middle of the list.
+func benchFleetNodes(n int) ([]corev1.Node, string) {
+	fleet := GPUFleet{Nodes: n, NFD: true}
+	nodes := make([]corev1.Node, n)
+	for i := range nodes {
+		nodes[i] = *fleet.NewNode(i)
+		if i%10 == 0 {
+			delete(nodes[i].Labels, "nvidia.com/gpu.present")
+			delete(nodes[i].Status.Allocatable, GPUResource)
+		}
+	}
+	return nodes, fleet.WorkerName(n / 2)
+}
+
+func TestNodeSet(t *testing.T) {
+	nodes, name := benchFleetNodes(100)
+	set := NewNodeSet(nodes)
+	if node, ok := set.Get(name); !ok || node.Name != name {
+		t.Errorf("Get(%s) = %v, %v", name, node, ok)
+	}
+	if got := len(set.WithLabel("nvidia.com/gpu.present", "true")); got != 90 {
+		t.Errorf("got %d GPU nodes by label, want 90", got)
+	}
+	if got := len(set.WithAllocatable(GPUResource)); got != 90 {
+		t.Errorf("got %d GPU nodes by allocatable, want 90", got)
+	}
+}
+
+var (
+	nodeSink  corev1.Node
+	nodesSink []*corev1.Node
+)
+
+// BenchmarkNodeSet compares NodeSet lookups on 5,000 nodes with the linear
+// scans they replace.
+func BenchmarkNodeSet(b *testing.B) {
+	nodes, name := benchFleetNodes(5000)
+	set := NewNodeSet(nodes)
+
+	b.Run("Build", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			set = NewNodeSet(nodes)
+		}
+	})
+	b.Run("Get/NodeSet", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			node, _ := set.Get(name)
+			nodeSink = *node
+		}
+	})
+	b.Run("Get/GetNode", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			nodeSink = GetNode(nodes, name)
+		}
+	})
+	b.Run("WithLabel/NodeSet", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			nodesSink = set.WithLabel("nvidia.com/gpu.present", "true")
+		}
+	})
+	b.Run("WithLabel/Scan", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			var out []*corev1.Node
+			for j := range nodes {
+				if nodes[j].Labels["nvidia.com/gpu.present"] == "true" {
+					out = append(out, &nodes[j])
+				}
+			}
+			nodesSink = out
+		}
+	})
+	b.Run("WithAllocatable/NodeSet", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			nodesSink = set.WithAllocatable(GPUResource)
+		}
+	})
+	b.Run("WithAllocatable/Scan", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			var out []*corev1.Node
+			for j := range nodes {
+				if q, ok := nodes[j].Status.Allocatable[GPUResource]; ok && !q.IsZero() {
+					out = append(out, &nodes[j])
+				}
+			}
+			nodesSink = out
+		}
+	})
+}
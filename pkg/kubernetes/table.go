@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"encoding/json"
+	"errors"
+	"fmt"
+
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	clientset "k8s.io/client-go/kubernetes"
+	"k8s.io/client-go/rest"
+)
+
+// TableMetadataAccept requests a server-side Table projection of a list,
+// with the metadata of every object in its rows when the request sets
+// includeObject=Metadata.
+const TableMetadataAccept = "application/json;as=Table;v=v1;g=meta.k8s.io,application/json"
+
+// ErrNoRESTClient is returned for raw requests through a clientset without
+// a usable REST client, such as the fake clientsets of simulated clusters.
+var ErrNoRESTClient = errors.New("clientset has no REST client for raw requests")
+
+// RESTClient returns the REST client of cs for raw requests. Fake clientsets
+// return a nil *rest.RESTClient that panics on first use, so it is rejected
+// with ErrNoRESTClient.
+func RESTClient(cs clientset.Interface) (rest.Interface, error) {
+	rc := cs.CoreV1().RESTClient()
+	if c, ok := rc.(*rest.RESTClient); rc == nil || ok && c == nil {
+		return nil, ErrNoRESTClient
+	}
+	return rc, nil
+}
+
+// DecodeMetadataTable decodes a list response requested with
+// TableMetadataAccept into the metadata of its rows and the continue token
+// of the next page.
+func DecodeMetadataTable(data []byte) ([]metav1.PartialObjectMetadata, string, error) {
+	var table metav1.Table
+	if err := json.Unmarshal(data, &table); err != nil {
+		return nil, "", fmt.Errorf("error decoding table: %w", err)
+	}
+	if table.Kind != "Table" {
+		return nil, "", fmt.Errorf("server returned %s instead of a table", table.Kind)
+	}
+	out := make([]metav1.PartialObjectMetadata, len(table.Rows))
+	for i, row := range table.Rows {
+		if err := json.Unmarshal(row.Object.Raw, &out[i]); err != nil {
+			return nil, "", fmt.Errorf("error decoding table row: %w", err)
+		}
+	}
+	return out, table.Continue, nil
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"context"
+	"errors"
+	"testing"
+
+	clientset "k8s.io/client-go/kubernetes"
+	corev1client "k8s.io/client-go/kubernetes/typed/core/v1"
+	"k8s.io/client-go/rest"
+)
+
+// noRESTClientset stands in for a fake clientset, whose REST client is a
+// nil *rest.RESTClient.
+type noRESTClientset struct{ clientset.Interface }
+
+func (noRESTClientset) CoreV1() corev1client.CoreV1Interface { return noRESTCoreV1{} }
+
+type noRESTCoreV1 struct{ corev1client.CoreV1Interface }
+
+func (noRESTCoreV1) RESTClient() rest.Interface {
+	var ret *rest.RESTClient
+	return ret
+}
+
+func TestListNodeMetadata(t *testing.T) {
+	server := newFakeAPIServer(t)
+	seedFleet(server, GPUFleet{Nodes: 3, ControlPlaneNodes: 1})
+	ctx := context.Background()
+
+	nodes, err := ListNodeMetadata(ctx, server.clientset(t), "")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if len(nodes) != 4 {
+		t.Errorf("got %d nodes, want 4", len(nodes))
+	}
+	for _, node := range nodes {
+		if node.Name == "" || node.ResourceVersion == "" {
+			t.Errorf("incomplete node metadata: %+v", node.ObjectMeta)
+		}
+	}
+
+	if _, err := ListNodeMetadata(ctx, noRESTClientset{}, ""); !errors.Is(err, ErrNoRESTClient) {
+		t.Errorf("got error %v without a REST client, want %v", err, ErrNoRESTClient)
+	}
+}
+
+func TestListNodeMetadataPages(t *testing.T) {
+	server := newFakeAPIServer(t)
+	fleet := GPUFleet{Nodes: 2*nodeMetadataPageSize + 10}
+	seedFleet(server, fleet)
+
+	nodes, err := ListNodeMetadata(context.Background(), server.clientset(t), "")
+	if err != nil {
+		t.Fatal(err)
+	}
+	seen := map[string]bool{}
+	for _, node := range nodes {
+		seen[node.Name] = true
+	}
+	if len(nodes) != fleet.Nodes || len(seen) != fleet.Nodes {
+		t.Errorf("got %d nodes, %d distinct, want %d", len(nodes), len(seen), fleet.Nodes)
+	}
+	if got := server.count("GET nodes"); got != 3 {
+		t.Errorf("got %d list requests, want 3 pages", got)
+	}
+}
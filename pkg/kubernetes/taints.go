@@ -17,6 +17,8 @@
 package kubernetes
 
 import (
+	"strings"
+
 	corev1 "k8s.io/api/core/v1"
 )
 
@@ -43,3 +45,57 @@ func DeleteTaint(taints []corev1.Taint, taintToDelete *corev1.Taint) ([]corev1.T
 	}
 	return newTaints, deleted
 }
+
+// DeleteTaintsFunc removes the taints for which del returns true in a single
+// pass. It reuses the backing array of taints and does not allocate, so the
+// caller must not use taints afterwards, and must pass a copy if the slice is
+// shared, e.g. with an informer cache. It reports whether any taint was
+// removed, so that callers can skip the API write otherwise.
+func DeleteTaintsFunc(taints []corev1.Taint, del func(*corev1.Taint) bool) ([]corev1.Taint, bool) {
+	i := 0
+	for i < len(taints) && !del(&taints[i]) {
+		i++
+	}
+	if i == len(taints) {
+		return taints, false
+	}
+	kept := i
+	for i++; i < len(taints); i++ {
+		if !del(&taints[i]) {
+			taints[kept] = taints[i]
+			kept++
+		}
+	}
+	// Do not keep the removed taints reachable through the backing array.
+	for i := kept; i < len(taints); i++ {
+		taints[i] = corev1.Taint{}
+	}
+	return taints[:kept], true
+}
+
+// DeleteTaintsWithKeyPrefix removes the taints whose key starts with prefix.
+// See DeleteTaintsFunc.
+func DeleteTaintsWithKeyPrefix(taints []corev1.Taint, prefix string) ([]corev1.Taint, bool) {
+	return DeleteTaintsFunc(taints, func(t *corev1.Taint) bool {
+		return strings.HasPrefix(t.Key, prefix)
+	})
+}
+
+// AddOrUpdateTaint sets the value of the taint with the same key and effect
+// as taint, or appends taint if there is none. It only allocates when the
+// taint is appended beyond the capacity of taints, and reports whether
+// anything changed.
+func AddOrUpdateTaint(taints []corev1.Taint, taint *corev1.Taint) ([]corev1.Taint, bool) {
+	for i := range taints {
+		if !taint.MatchTaint(&taints[i]) {
+			continue
+		}
+		if taints[i].Value == taint.Value {
+			return taints, false
+		}
+		taints[i].Value = taint.Value
+		taints[i].TimeAdded = taint.TimeAdded
+		return taints, true
+	}
+	return append(taints, *taint), true
+}
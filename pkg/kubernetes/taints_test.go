@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package kubernetes
+
+import (
+	"reflect"
+	"testing"
+
+	corev1 "k8s.io/api/core/v1"
+	nfdv1alpha1 "sigs.k8s.io/node-feature-discovery/pkg/apis/nfd/v1alpha1"
+)
+
+func benchTaints() []corev1.Taint {
+	return []corev1.Taint{
+		{Key: "example.com/a", Effect: corev1.TaintEffectNoSchedule},
+		{Key: nfdv1alpha1.TaintNs + "/gpu", Effect: corev1.TaintEffectNoSchedule},
+		{Key: "example.com/b", Value: "1", Effect: corev1.TaintEffectPreferNoSchedule},
+		{Key: nfdv1alpha1.TaintNs + "/ib", Effect: corev1.TaintEffectNoExecute},
+		{Key: "example.com/c", Effect: corev1.TaintEffectNoSchedule},
+	}
+}
+
+func TestDeleteTaintsWithKeyPrefix(t *testing.T) {
+	taints := benchTaints()
+	got, deleted := DeleteTaintsWithKeyPrefix(taints, nfdv1alpha1.TaintNs)
+	want := []corev1.Taint{benchTaints()[0], benchTaints()[2], benchTaints()[4]}
+	if !deleted || !reflect.DeepEqual(got, want) {
+		t.Errorf("got %v, %v; want %v, true", got, deleted, want)
+	}
+	if tail := taints[len(got):]; !reflect.DeepEqual(tail, make([]corev1.Taint, len(tail))) {
+		t.Errorf("removed taints still reachable: %v", tail)
+	}
+	if _, deleted := DeleteTaintsWithKeyPrefix(got, nfdv1alpha1.TaintNs); deleted {
+		t.Error("reported a deletion without NFD taints")
+	}
+}
+
+func TestAddOrUpdateTaint(t *testing.T) {
+	taints := benchTaints()
+	update := corev1.Taint{Key: "example.com/b", Value: "2", Effect: corev1.TaintEffectPreferNoSchedule}
+	taints, changed := AddOrUpdateTaint(taints, &update)
+	if !changed || len(taints) != 5 || taints[2].Value != "2" {
+		t.Errorf("update: got %v, %v", taints, changed)
+	}
+	if _, changed := AddOrUpdateTaint(taints, &update); changed {
+		t.Error("reported a change for an identical taint")
+	}
+	add := corev1.Taint{Key: "example.com/b", Effect: corev1.TaintEffectNoExecute}
+	if taints, changed = AddOrUpdateTaint(taints, &add); !changed || len(taints) != 6 {
+		t.Errorf("add: got %v, %v", taints, changed)
+	}
+}
+
+var taintsSink []corev1.Taint
+
+// BenchmarkTaints compares the in-place taint helpers with DeleteTaint, which
+// allocates a new list per deleted taint. Every iteration starts from a fresh
+// copy of the same five taints.
+func BenchmarkTaints(b *testing.B) {
+	taints := benchTaints()
+	buf := make([]corev1.Taint, len(taints), len(taints)+1)
+	nfdTaints := []corev1.Taint{taints[1], taints[3]}
+
+	b.Run("DeleteTaintsWithKeyPrefix", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			copy(buf, taints)
+			taintsSink, _ = DeleteTaintsWithKeyPrefix(buf[:len(taints)], nfdv1alpha1.TaintNs)
+		}
+	})
+	b.Run("DeleteTaint", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			copy(buf, taints)
+			out := buf[:len(taints)]
+			for j := range nfdTaints {
+				out, _ = DeleteTaint(out, &nfdTaints[j])
+			}
+			taintsSink = out
+		}
+	})
+	update := corev1.Taint{Key: "example.com/b", Value: "2", Effect: corev1.TaintEffectPreferNoSchedule}
+	b.Run("AddOrUpdateTaint/Update", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			copy(buf, taints)
+			taintsSink, _ = AddOrUpdateTaint(buf[:len(taints)], &update)
+		}
+	})
+	add := corev1.Taint{Key: "example.com/d", Effect: corev1.TaintEffectNoSchedule}
+	b.Run("AddOrUpdateTaint/Append", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			copy(buf, taints)
+			taintsSink, _ = AddOrUpdateTaint(buf[:len(taints)], &add)
+		}
+	})
+}